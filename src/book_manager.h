@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "mbo_decoder.h"
+#include "price_levels.h"
+
+// --- Multi-instrument books ---
+// One book per (publisher_id, instrument_id), so a full-venue file is
+// reconstructed in a single pass. Books live in a dense vector; a hash map
+// turns the key into an index, and the last key is cached because a feed
+// usually carries runs of events for the same instrument, which makes the
+// common lookup a single compare. `State` is whatever else the caller keeps
+// per book.
+struct NoBookState {};
+
+template <typename Book, typename State = NoBookState>
+class BookManager {
+public:
+    struct Entry {
+        explicit Entry(const LevelConfig& levels) : book(levels) {}
+        Book book;
+        std::string symbol; // first non-empty symbol seen for the instrument
+        uint16_t publisher_id = 0;
+        uint32_t instrument_id = 0;
+        size_t index = 0; // position in creation order, a compact id for the book
+        bool started = false; // set by the caller once it has handled an event for the book
+        State state;
+    };
+
+    explicit BookManager(const LevelConfig& levels = LevelConfig()) : levels_(levels) {}
+
+    // The book `event` belongs to, created on first sight.
+    Entry& bookFor(const MboEvent& event) {
+        const uint64_t key = (uint64_t(event.publisher_id) << 32) | event.instrument_id;
+        if (last_ == nullptr || key != last_key_) {
+            auto [it, inserted] = index_.try_emplace(key, entries_.size());
+            if (inserted) {
+                entries_.emplace_back(new Entry(levels_));
+                entries_.back()->publisher_id = event.publisher_id;
+                entries_.back()->instrument_id = event.instrument_id;
+                entries_.back()->index = entries_.size() - 1;
+                // Most files hold one instrument: give it the whole pre-size hint.
+                if (entries_.size() == 1) entries_.back()->book.reserveOrders(reserve_hint_);
+            }
+            last_ = entries_[it->second].get();
+            last_key_ = key;
+        }
+        if (last_->symbol.empty() && !event.symbol.empty()) last_->symbol.assign(event.symbol);
+        return *last_;
+    }
+
+    // Order table size hint for the first book.
+    void reserveOrders(size_t orders) {
+        reserve_hint_ = orders;
+        if (!entries_.empty()) entries_.front()->book.reserveOrders(orders);
+    }
+
+    size_t size() const { return entries_.size(); }
+    Entry& operator[](size_t i) { return *entries_[i]; }
+
+private:
+    LevelConfig levels_;
+    std::vector<std::unique_ptr<Entry>> entries_;
+    std::unordered_map<uint64_t, size_t> index_;
+    Entry* last_ = nullptr;
+    uint64_t last_key_ = 0;
+    size_t reserve_hint_ = 0;
+};
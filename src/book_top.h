@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+
+#include "price_levels.h"
+
+// Returned by book mutations that leave the visible depth untouched.
+constexpr int kNoVisibleChange = -1;
+
+// --- Materialized top of book ---
+// The best N levels of one side, kept in flat arrays that fit in a few cache
+// lines and updated as each change is applied to the side's level container.
+// A change to a visible level is patched in place, a new level inside the
+// visible range is shifted in, and a change beyond the visible range costs a
+// single comparison against the worst visible price. Only when a visible
+// level empties is the array reloaded from the container, to pull up the
+// next level. Snapshots read the arrays directly.
+template <typename Price, typename Better, size_t N>
+class alignas(64) TopLevels {
+public:
+    // Mirrors an update that was just applied to `levels`, the side's full
+    // container. Returns the index of the first visible level that changed,
+    // or kNoVisibleChange.
+    template <typename Levels>
+    int update(const Levels& levels, Price price, int size_diff, int count_diff) {
+        Better better;
+        if (depth_ == N && better(prices_[N - 1], price)) return kNoVisibleChange;
+        size_t i = 0;
+        while (i < depth_ && better(prices_[i], price)) ++i;
+        if (i < depth_ && prices_[i] == price) {
+            totals_[i].size += size_diff;
+            totals_[i].count += count_diff;
+            if (totals_[i].size <= 0) reload(levels);
+            return static_cast<int>(i);
+        }
+        // Otherwise the level did not exist: only an increase creates it, and
+        // only one that ranks inside the top N is visible.
+        if (size_diff <= 0) return kNoVisibleChange;
+        for (size_t j = (depth_ < N ? depth_ : N - 1); j > i; --j) {
+            prices_[j] = prices_[j - 1];
+            totals_[j] = totals_[j - 1];
+        }
+        prices_[i] = price;
+        totals_[i] = LevelTotal{size_diff, count_diff};
+        if (depth_ < N) ++depth_;
+        return static_cast<int>(i);
+    }
+
+    // Rebuilds the array from the container.
+    template <typename Levels>
+    void reload(const Levels& levels) {
+        depth_ = 0;
+        levels.forEachBest(N, [this](Price price, int size, int count) {
+            prices_[depth_] = price;
+            totals_[depth_] = LevelTotal{size, count};
+            ++depth_;
+        });
+    }
+
+    void clear() { depth_ = 0; }
+
+    // Number of visible levels (at most N).
+    size_t depth() const { return depth_; }
+    Price price(size_t i) const { return prices_[i]; }
+    const LevelTotal& total(size_t i) const { return totals_[i]; }
+
+private:
+    Price prices_[N];
+    LevelTotal totals_[N];
+    size_t depth_ = 0;
+};
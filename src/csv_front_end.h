@@ -0,0 +1,200 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "csv_scanner.h"
+#include "mbo_decoder.h"
+
+// --- CSV Front End ---
+
+// Input is indexed by the structural scanner in blocks of about this size.
+constexpr size_t kScanBlockBytes = 1 << 18;
+
+// With --parse-threads, each thread decodes about this much input per round.
+constexpr size_t kParseChunkBytes = 1 << 21;
+
+// Receives decoded MBO events in input order, a batch at a time. The input
+// front ends only talk to this interface, so they are compiled once rather
+// than once per book type; the per-batch virtual call is all it costs.
+class EventSink {
+public:
+    virtual ~EventSink() = default;
+    virtual void onEvents(const MboEvent* events, size_t count) = 0;
+    // Pre-sizes the order table for an input of `input_bytes`.
+    virtual void reserveFor(size_t input_bytes) = 0;
+    // Writes out anything held back for events still to come; called after the last event.
+    virtual void finish() = 0;
+    // Milliseconds from the start time to the first emitted snapshot, or -1 if none yet.
+    virtual double firstEventMs() const = 0;
+};
+
+// Turns runs of whole CSV lines into MboEvents. The first line it sees is the
+// header, which fixes the column plan for the rest.
+//
+// With more than one parse thread, the extra workers are started once and
+// parked between windows, so a window costs two handshakes rather than
+// creating and joining a thread per worker.
+class CsvFrontEnd {
+public:
+    CsvFrontEnd(ScanKernel kernel, size_t parse_threads, EventSink& sink, size_t parse_chunk_bytes = kParseChunkBytes)
+        : scanner_(kernel), sink_(sink), parse_chunk_bytes_(parse_chunk_bytes) {
+        for (size_t i = 1; i < parse_threads; ++i) parsers_.emplace_back(new ChunkParser(kernel));
+        for (auto& parser : parsers_) parser->worker = std::thread([this, &parser = *parser] { workLoop(parser); });
+    }
+
+    CsvFrontEnd(const CsvFrontEnd&) = delete;
+    CsvFrontEnd& operator=(const CsvFrontEnd&) = delete;
+
+    ~CsvFrontEnd() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        start_cv_.notify_all();
+        for (auto& parser : parsers_) parser->worker.join();
+    }
+
+    // Processes `lines`, which must end on a line boundary (or at end of input).
+    // Returns false if the input cannot be decoded.
+    bool consume(std::string_view lines) {
+        if (!have_header_) {
+            size_t first_newline = lines.find('\n');
+            MboColumnPlan plan;
+            std::string_view missing_column;
+            if (!MboColumnPlan::fromHeader(lines.substr(0, first_newline), plan, missing_column)) {
+                std::cerr << "Error: Input header has no '" << missing_column << "' column.\n";
+                return false;
+            }
+            decoder_ = MboCsvDecoder(plan);
+            have_header_ = true;
+            lines = (first_newline == std::string_view::npos) ? std::string_view() : lines.substr(first_newline + 1);
+        }
+
+        if (!parsers_.empty()) {
+            consumeParallel(lines);
+            return true;
+        }
+
+        while (!lines.empty()) {
+            // Cut each block after its last complete line so no line straddles two blocks.
+            size_t block_end = lineBlockLength(lines, kScanBlockBytes);
+            processBlock(lines.substr(0, block_end));
+            lines.remove_prefix(block_end);
+        }
+        return true;
+    }
+
+private:
+    StructuralScanner scanner_;
+    CsvRecord record_;
+    MboCsvDecoder decoder_;
+    MboEvent event_;
+    EventSink& sink_;
+    size_t parse_chunk_bytes_;
+    bool have_header_ = false;
+
+    // One parser per extra --parse-threads worker: its thread, its own
+    // scanner, and its chunk of the current window with the events decoded from it.
+    struct ChunkParser {
+        explicit ChunkParser(ScanKernel kernel) : scanner(kernel) {}
+        StructuralScanner scanner;
+        std::string_view chunk;
+        std::vector<MboEvent> events;
+        std::thread worker;
+    };
+    std::vector<std::unique_ptr<ChunkParser>> parsers_;
+    std::vector<MboEvent> events_; // the calling thread's share, or the current block's events
+
+    // Window handshake: consumeParallel() bumps `round_` to start the workers
+    // on their chunks and waits until `pending_` drops back to zero.
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    uint64_t round_ = 0;
+    size_t pending_ = 0;
+    bool stop_ = false;
+
+    void workLoop(ChunkParser& parser) {
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                start_cv_.wait(lock, [&] { return stop_ || round_ != seen; });
+                if (stop_) return;
+                seen = round_;
+            }
+            parseChunk(parser.chunk, parser.scanner, parser.events);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (--pending_ != 0) continue;
+            }
+            done_cv_.notify_one();
+        }
+    }
+
+    void parseChunk(std::string_view chunk, StructuralScanner& scanner, std::vector<MboEvent>& events) const {
+        events.clear();
+        CsvRecord record;
+        MboEvent event;
+        while (!chunk.empty()) {
+            size_t block_end = lineBlockLength(chunk, kScanBlockBytes);
+            scanner.scan(chunk.substr(0, block_end));
+            chunk.remove_prefix(block_end);
+            while (scanner.next(record)) {
+                if (decoder_.decode(record, event)) events.push_back(event);
+            }
+        }
+    }
+
+    // --- Parallel pre-parse: decode newline-aligned chunks concurrently into
+    // MboEvent arrays, then apply them to the book in input order ---
+    void consumeParallel(std::string_view lines) {
+        const size_t threads = parsers_.size() + 1;
+
+        while (!lines.empty()) {
+            std::string_view window = lines.substr(0, lineBlockLength(lines, threads * parse_chunk_bytes_));
+            lines.remove_prefix(window.size());
+
+            const size_t share = (window.size() + threads - 1) / threads;
+            std::string_view own = window.substr(0, lineBlockLength(window, share));
+            window.remove_prefix(own.size());
+            for (size_t i = 0; i < parsers_.size(); ++i) {
+                size_t length = (i + 1 == parsers_.size()) ? window.size() : lineBlockLength(window, share);
+                parsers_[i]->chunk = window.substr(0, length);
+                window.remove_prefix(length);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                ++round_;
+                pending_ = parsers_.size();
+            }
+            start_cv_.notify_all();
+            parseChunk(own, scanner_, events_);
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                done_cv_.wait(lock, [this] { return pending_ == 0; });
+            }
+
+            sink_.onEvents(events_.data(), events_.size());
+            for (const auto& parser : parsers_) sink_.onEvents(parser->events.data(), parser->events.size());
+        }
+    }
+
+    // --- Optimization: Index delimiters a block at a time with the SIMD scanner ---
+    void processBlock(std::string_view block) {
+        scanner_.scan(block);
+        events_.clear();
+        while (scanner_.next(record_)) {
+            if (decoder_.decode(record_, event_)) events_.push_back(event_);
+        }
+        sink_.onEvents(events_.data(), events_.size());
+    }
+};
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CSV_SCANNER_X86 1
+#endif
+
+// --- Structural CSV scanner ---
+// Finds every ',' and '\n' in a block of input and records their offsets in a
+// flat index, 16 or 32 bytes per step on x86. Lines and fields are then read
+// straight out of the index: no per-line allocation and no per-byte branching
+// in the parse loop.
+
+enum class ScanKernel { Auto, Scalar, Sse2, Avx2 };
+
+namespace csv_detail {
+
+using ScanFn = size_t (*)(const char* data, size_t len, uint32_t* out);
+
+// Appends the offset of every delimiter in `mask` (bit i == data[base + i]).
+inline size_t emitMask(uint32_t mask, uint32_t base, uint32_t* out, size_t n) {
+    while (mask != 0) {
+        out[n++] = base + static_cast<uint32_t>(__builtin_ctz(mask));
+        mask &= mask - 1;
+    }
+    return n;
+}
+
+// Portable fallback, also used for the tail of a block. The store is
+// unconditional and only the count depends on the byte, which keeps the loop
+// free of data-dependent branches.
+inline size_t scanRange(const char* data, size_t begin, size_t end, uint32_t* out, size_t n) {
+    for (size_t i = begin; i < end; ++i) {
+        const char c = data[i];
+        out[n] = static_cast<uint32_t>(i);
+        n += (c == ',') | (c == '\n');
+    }
+    return n;
+}
+
+inline size_t scanScalar(const char* data, size_t len, uint32_t* out) {
+    return scanRange(data, 0, len, out, 0);
+}
+
+#ifdef CSV_SCANNER_X86
+__attribute__((target("sse2")))
+inline size_t scanSse2(const char* data, size_t len, uint32_t* out) {
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i newline = _mm_set1_epi8('\n');
+    size_t n = 0;
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(chunk, comma), _mm_cmpeq_epi8(chunk, newline));
+        n = emitMask(static_cast<uint32_t>(_mm_movemask_epi8(hits)), static_cast<uint32_t>(i), out, n);
+    }
+    return scanRange(data, i, len, out, n);
+}
+
+__attribute__((target("avx2")))
+inline size_t scanAvx2(const char* data, size_t len, uint32_t* out) {
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    size_t n = 0;
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i hits = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, comma), _mm256_cmpeq_epi8(chunk, newline));
+        n = emitMask(static_cast<uint32_t>(_mm256_movemask_epi8(hits)), static_cast<uint32_t>(i), out, n);
+    }
+    return scanRange(data, i, len, out, n);
+}
+#endif
+
+inline ScanFn selectScanFn(ScanKernel kernel) {
+#ifdef CSV_SCANNER_X86
+    __builtin_cpu_init();
+    switch (kernel) {
+        case ScanKernel::Scalar: return scanScalar;
+        case ScanKernel::Sse2: return scanSse2;
+        case ScanKernel::Avx2: return __builtin_cpu_supports("avx2") ? scanAvx2 : scanSse2;
+        case ScanKernel::Auto: break;
+    }
+    return __builtin_cpu_supports("avx2") ? scanAvx2 : scanSse2;
+#else
+    (void)kernel;
+    return scanScalar;
+#endif
+}
+
+} // namespace csv_detail
+
+// Field boundaries of one CSV line inside a scanned block.
+class CsvRecord {
+public:
+    size_t fieldCount() const { return count_; }
+
+    std::string_view field(size_t i) const {
+        uint32_t begin = (i == 0) ? start_ : delims_[i - 1] + 1;
+        return std::string_view(base_ + begin, delims_[i] - begin);
+    }
+
+    std::string_view line() const {
+        return std::string_view(base_ + start_, delims_[count_ - 1] - start_);
+    }
+
+private:
+    friend class StructuralScanner;
+    const char* base_ = nullptr;
+    const uint32_t* delims_ = nullptr;
+    uint32_t start_ = 0;
+    size_t count_ = 0;
+};
+
+// Indexes one block at a time into a buffer that is reused across blocks, then
+// hands out the block's lines as CsvRecords. A block must hold whole lines;
+// the last line may omit its trailing newline.
+class StructuralScanner {
+public:
+    explicit StructuralScanner(ScanKernel kernel = ScanKernel::Auto)
+        : scan_(csv_detail::selectScanFn(kernel)) {}
+
+    void scan(std::string_view block) {
+        // Worst case every byte is a delimiter, plus one for a missing final newline.
+        if (index_.size() < block.size() + 1) index_.resize(block.size() + 1);
+        base_ = block.data();
+        size_ = static_cast<uint32_t>(block.size());
+        count_ = scan_(block.data(), block.size(), index_.data());
+        if (size_ != 0 && block.back() != '\n') index_[count_++] = size_;
+        cursor_ = 0;
+        line_start_ = 0;
+    }
+
+    // Advances to the next line of the current block; false once it is exhausted.
+    bool next(CsvRecord& record) {
+        if (cursor_ >= count_) return false;
+        const size_t first = cursor_;
+        while (index_[cursor_] != size_ && base_[index_[cursor_]] != '\n') ++cursor_;
+        record.base_ = base_;
+        record.delims_ = index_.data() + first;
+        record.start_ = line_start_;
+        record.count_ = ++cursor_ - first;
+        line_start_ = index_[cursor_ - 1] + 1;
+        return true;
+    }
+
+private:
+    csv_detail::ScanFn scan_;
+    std::vector<uint32_t> index_;
+    const char* base_ = nullptr;
+    uint32_t size_ = 0;
+    size_t count_ = 0;
+    size_t cursor_ = 0;
+    uint32_t line_start_ = 0;
+};
+
+// Length of the leading block of `lines` to hand to StructuralScanner::scan:
+// at most `max_bytes`, cut after the last complete line, or stretched to the
+// end of the first line if that line alone is longer than `max_bytes`.
+inline size_t lineBlockLength(std::string_view lines, size_t max_bytes) {
+    if (lines.size() <= max_bytes) return lines.size();
+    const void* last_newline = memrchr(lines.data(), '\n', max_bytes);
+    if (last_newline != nullptr) return static_cast<const char*>(last_newline) - lines.data() + 1;
+    size_t next_newline = lines.find('\n', max_bytes);
+    return (next_newline == std::string_view::npos) ? lines.size() : next_newline + 1;
+}
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "field_parsers.h"
+#include "mbo_decoder.h"
+
+// --- Databento Binary Encoding (DBN) ---
+// A DBN stream is a metadata block ("DBN" + version byte + u32 length +
+// metadata) followed by little-endian records that each start with a
+// RecordHeader. MBO records are fixed-size with integer 1e-9 prices and
+// nanosecond timestamps, so they map straight onto MboEvent with no text
+// parsing at all. Only the fields needed to replay MBO data are interpreted:
+// from the metadata that is the symbology, which names each instrument id.
+
+constexpr char kDbnMagic[3] = {'D', 'B', 'N'};
+constexpr uint8_t kDbnVersion = 2;
+constexpr uint8_t kDbnRTypeMbo = 0xA0;
+constexpr uint16_t kDbnSchemaMbo = 0;
+constexpr uint8_t kDbnSTypeInstrumentId = 0;
+constexpr uint8_t kDbnSTypeRawSymbol = 1;
+constexpr uint16_t kDbnSymbolCstrLen = 71; // DBN v2
+constexpr uint16_t kDbnV1SymbolCstrLen = 22;
+constexpr size_t kDbnV1MetadataReserved = 47;
+constexpr size_t kDbnMetadataReserved = 53; // DBN v2
+constexpr size_t kDbnPrefixBytes = 8; // magic, version, u32 metadata length
+constexpr int64_t kDbnUndefPrice = std::numeric_limits<int64_t>::max();
+
+// True if `data` starts with the DBN magic bytes.
+inline bool isDbn(std::string_view data) {
+    return data.size() >= sizeof(kDbnMagic) && std::memcmp(data.data(), kDbnMagic, sizeof(kDbnMagic)) == 0;
+}
+
+#pragma pack(push, 1)
+struct DbnRecordHeader {
+    uint8_t length; // record size in 4-byte words
+    uint8_t rtype;
+    uint16_t publisher_id;
+    uint32_t instrument_id;
+    uint64_t ts_event;
+};
+
+struct DbnMboRecord {
+    DbnRecordHeader hd;
+    uint64_t order_id;
+    int64_t price;
+    uint32_t size;
+    uint8_t flags;
+    uint8_t channel_id;
+    char action;
+    char side;
+    uint64_t ts_recv;
+    int32_t ts_in_delta;
+    uint32_t sequence;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(DbnRecordHeader) == 16, "DBN record header is 16 bytes");
+static_assert(sizeof(DbnMboRecord) == 56, "DBN MBO record is 56 bytes");
+
+// Incremental DBN decoder. Chunks may split the metadata or a record at any
+// byte; only a record that straddles two chunks is copied.
+class DbnDecoder {
+public:
+    // Decodes the MBO records in `chunk`, calling `sink(const MboEvent&)` for
+    // each. Returns false on a malformed stream (see error()).
+    template <typename Sink>
+    bool feed(std::string_view chunk, Sink&& sink) {
+        const char* p = chunk.data();
+        const char* end = p + chunk.size();
+
+        if (state_ == State::Prefix) {
+            size_t take = std::min<size_t>(kDbnPrefixBytes - pending_.size(), end - p);
+            pending_.append(p, take);
+            p += take;
+            if (pending_.size() < kDbnPrefixBytes) return true;
+            if (!isDbn(pending_) || static_cast<uint8_t>(pending_[3]) == 0) return fail("not a DBN stream");
+            uint32_t metadata_length;
+            std::memcpy(&metadata_length, pending_.data() + 4, sizeof(metadata_length));
+            version_ = static_cast<uint8_t>(pending_[3]);
+            pending_.clear();
+            metadata_length_ = metadata_length;
+            state_ = State::Metadata;
+        }
+
+        if (state_ == State::Metadata) {
+            size_t take = std::min<size_t>(metadata_length_ - pending_.size(), end - p);
+            pending_.append(p, take);
+            p += take;
+            if (pending_.size() < metadata_length_) return true;
+            parseSymbology(pending_);
+            pending_.clear();
+            state_ = State::Records;
+        }
+
+        if (!pending_.empty()) {
+            size_t record_bytes = static_cast<uint8_t>(pending_[0]) * 4;
+            size_t take = std::min<size_t>(record_bytes - pending_.size(), end - p);
+            pending_.append(p, take);
+            p += take;
+            if (pending_.size() < record_bytes) return true;
+            decodeRecord(pending_.data(), record_bytes, sink);
+            pending_.clear();
+        }
+
+        while (p < end) {
+            size_t record_bytes = static_cast<uint8_t>(*p) * 4;
+            if (record_bytes < sizeof(DbnRecordHeader)) return fail("invalid record length");
+            if (static_cast<size_t>(end - p) < record_bytes) {
+                pending_.assign(p, end);
+                break;
+            }
+            decodeRecord(p, record_bytes, sink);
+            p += record_bytes;
+        }
+        return true;
+    }
+
+    // Call at end of input; false if the stream stopped mid-record.
+    bool finish() {
+        if (state_ != State::Records) return fail("truncated DBN metadata");
+        if (!pending_.empty()) return fail("truncated DBN record");
+        return true;
+    }
+
+    const std::string& error() const { return error_; }
+
+    // Raw symbol of `instrument_id` from the metadata's symbology, or empty.
+    std::string_view symbolOf(uint32_t instrument_id) const {
+        auto it = symbols_.find(instrument_id);
+        return it != symbols_.end() ? std::string_view(it->second) : std::string_view();
+    }
+
+private:
+    enum class State { Prefix, Metadata, Records };
+
+    State state_ = State::Prefix;
+    uint8_t version_ = 0;
+    size_t metadata_length_ = 0;
+    std::string pending_;
+    std::string error_;
+    MboEvent event_;
+    std::unordered_map<uint32_t, std::string> symbols_;
+    // Records of one instrument usually come in runs; remember the last lookup.
+    uint32_t last_instrument_ = 0;
+    std::string_view last_symbol_;
+    bool have_last_ = false;
+
+    bool fail(const char* message) {
+        error_ = message;
+        return false;
+    }
+
+    // Reads the instrument id -> raw symbol mappings out of the metadata body.
+    // Symbology is optional for replay, so a body that does not parse as
+    // expected just leaves the table empty.
+    void parseSymbology(std::string_view body) {
+        size_t pos = 0;
+        auto skip = [&](size_t n) {
+            if (body.size() - pos < n) return false;
+            pos += n;
+            return true;
+        };
+        auto readU32 = [&](uint32_t& value) {
+            if (body.size() - pos < sizeof(value)) return false;
+            std::memcpy(&value, body.data() + pos, sizeof(value));
+            pos += sizeof(value);
+            return true;
+        };
+        size_t cstr_len = kDbnV1SymbolCstrLen;
+        // dataset, schema, start, end, limit
+        if (!skip(16 + 2 + 8 + 8 + 8)) return;
+        if (version_ == 1) {
+            if (!skip(8 + 3 + kDbnV1MetadataReserved)) return; // record_count, stypes, ts_out, reserved
+        } else {
+            uint16_t len;
+            if (!skip(3) || body.size() - pos < sizeof(len)) return; // stypes, ts_out
+            std::memcpy(&len, body.data() + pos, sizeof(len));
+            cstr_len = len;
+            if (cstr_len == 0 || !skip(sizeof(len) + kDbnMetadataReserved)) return;
+        }
+        auto readCstr = [&](std::string_view& text) {
+            if (body.size() - pos < cstr_len) return false;
+            text = body.substr(pos, cstr_len);
+            text = text.substr(0, std::min(text.find('\0'), text.size()));
+            pos += cstr_len;
+            return true;
+        };
+        uint32_t count;
+        if (!readU32(count) || !skip(count)) return; // schema definition
+        for (int list = 0; list < 3; ++list) { // symbols, partial, not_found
+            if (!readU32(count) || count > body.size() / cstr_len || !skip(size_t(count) * cstr_len)) return;
+        }
+        if (!readU32(count)) return;
+        for (uint32_t m = 0; m < count; ++m) {
+            std::string_view raw_symbol;
+            uint32_t intervals;
+            if (!readCstr(raw_symbol) || !readU32(intervals)) return;
+            for (uint32_t i = 0; i < intervals; ++i) {
+                std::string_view mapped;
+                if (!skip(8) || !readCstr(mapped)) return; // start_date, end_date
+                if (!mapped.empty() && mapped.find_first_not_of("0123456789") == std::string_view::npos) {
+                    symbols_[static_cast<uint32_t>(parseInteger(mapped))] = std::string(raw_symbol);
+                }
+            }
+        }
+    }
+
+    template <typename Sink>
+    void decodeRecord(const char* data, size_t record_bytes, Sink&& sink) {
+        if (static_cast<uint8_t>(data[1]) != kDbnRTypeMbo || record_bytes < sizeof(DbnMboRecord)) return;
+        DbnMboRecord record;
+        std::memcpy(&record, data, sizeof(record));
+
+        event_.ts_event = static_cast<int64_t>(record.hd.ts_event);
+        event_.action = record.action;
+        event_.side = record.side;
+        event_.price = FixedPrice{record.price == kDbnUndefPrice ? 0 : record.price};
+        event_.size = static_cast<int>(record.size);
+        event_.order_id = static_cast<long long>(record.order_id);
+        event_.flags = record.flags;
+        event_.ts_in_delta = record.ts_in_delta;
+        event_.sequence = record.sequence;
+        event_.publisher_id = record.hd.publisher_id;
+        event_.instrument_id = record.hd.instrument_id;
+        if (!have_last_ || record.hd.instrument_id != last_instrument_) {
+            last_instrument_ = record.hd.instrument_id;
+            last_symbol_ = symbolOf(last_instrument_);
+            have_last_ = true;
+        }
+        event_.symbol = last_symbol_;
+        sink(event_);
+    }
+};
+
+// Builds the DBN v2 metadata block for a single-schema MBO file. `symbols`
+// pairs each raw symbol with its instrument id, valid from `start_date` to
+// `end_date` (YYYYMMDD, end exclusive).
+inline std::string encodeDbnMetadata(uint64_t start_ns, uint64_t end_ns, uint32_t start_date, uint32_t end_date,
+                                     const std::vector<std::pair<std::string, uint32_t>>& symbols) {
+    std::string body;
+    auto put = [&body](const void* data, size_t size) { body.append(static_cast<const char*>(data), size); };
+    auto putCstr = [&body](std::string_view text) {
+        std::string field(kDbnSymbolCstrLen, '\0');
+        field.replace(0, std::min<size_t>(text.size(), kDbnSymbolCstrLen - 1), text.substr(0, kDbnSymbolCstrLen - 1));
+        body += field;
+    };
+
+    char dataset[16] = {};
+    put(dataset, sizeof(dataset));
+    put(&kDbnSchemaMbo, sizeof(kDbnSchemaMbo));
+    put(&start_ns, sizeof(start_ns));
+    put(&end_ns, sizeof(end_ns));
+    uint64_t limit = 0;
+    put(&limit, sizeof(limit));
+    put(&kDbnSTypeRawSymbol, 1);
+    put(&kDbnSTypeInstrumentId, 1);
+    uint8_t ts_out = 0;
+    put(&ts_out, 1);
+    put(&kDbnSymbolCstrLen, sizeof(kDbnSymbolCstrLen));
+    body.append(kDbnMetadataReserved, '\0');
+    uint32_t schema_definition_length = 0;
+    put(&schema_definition_length, sizeof(schema_definition_length));
+
+    uint32_t count = static_cast<uint32_t>(symbols.size());
+    uint32_t none = 0;
+    put(&count, sizeof(count)); // symbols
+    for (const auto& entry : symbols) putCstr(entry.first);
+    put(&none, sizeof(none)); // partial
+    put(&none, sizeof(none)); // not_found
+    put(&count, sizeof(count)); // mappings
+    for (const auto& [symbol, instrument_id] : symbols) {
+        putCstr(symbol);
+        uint32_t intervals = 1;
+        put(&intervals, sizeof(intervals));
+        put(&start_date, sizeof(start_date));
+        put(&end_date, sizeof(end_date));
+        putCstr(std::to_string(instrument_id));
+    }
+    // Records start 8-byte aligned.
+    body.append((8 - (kDbnPrefixBytes + body.size()) % 8) % 8, '\0');
+
+    std::string out(kDbnMagic, sizeof(kDbnMagic));
+    out += static_cast<char>(kDbnVersion);
+    uint32_t length = static_cast<uint32_t>(body.size());
+    out.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    return out + body;
+}
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#ifdef RECON_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef RECON_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "input_source.h"
+
+// --- Compressed Input ---
+// Archived MBO files are gzip or zstd compressed. DecodingStream recognises
+// the codec from the stream's magic bytes and decompresses on whatever thread
+// calls read(), which is the ChunkedReader's background thread, so
+// decompression overlaps with reconstruction instead of costing a separate pass.
+
+enum class Compression { None, Gzip, Zstd };
+
+inline Compression detectCompression(std::string_view head) {
+    if (head.size() >= 2 && static_cast<uint8_t>(head[0]) == 0x1F && static_cast<uint8_t>(head[1]) == 0x8B) {
+        return Compression::Gzip;
+    }
+    if (head.size() >= 4 && static_cast<uint8_t>(head[0]) == 0x28 && static_cast<uint8_t>(head[1]) == 0xB5 &&
+        static_cast<uint8_t>(head[2]) == 0x2F && static_cast<uint8_t>(head[3]) == 0xFD) {
+        return Compression::Zstd;
+    }
+    return Compression::None;
+}
+
+inline const char* compressionName(Compression compression) {
+    switch (compression) {
+        case Compression::Gzip: return "gzip";
+        case Compression::Zstd: return "zstd";
+        case Compression::None: break;
+    }
+    return "none";
+}
+
+// Reads a file descriptor (or any other byte source), transparently
+// decompressing gzip or zstd input. The codec is sniffed from the first bytes
+// read, so the input is never opened or read a second time for detection.
+class DecodingStream {
+public:
+    // Same contract as ChunkedReader::FillFn: bytes read, 0 at end, -1 on error.
+    using Source = ChunkedReader::FillFn;
+
+    explicit DecodingStream(int fd, size_t input_buffer_bytes = 1 << 20)
+        : DecodingStream([fd](char* buffer, size_t capacity) { return readFd(fd, buffer, capacity); },
+                         input_buffer_bytes) {}
+
+    explicit DecodingStream(Source source, size_t input_buffer_bytes = 1 << 20)
+        : source_(std::move(source)), in_(new char[input_buffer_bytes]), in_capacity_(input_buffer_bytes) {}
+
+    DecodingStream(const DecodingStream&) = delete;
+    DecodingStream& operator=(const DecodingStream&) = delete;
+
+    ~DecodingStream() {
+#ifdef RECON_HAVE_ZLIB
+        if (compression_ == Compression::Gzip) inflateEnd(&gzip_);
+#endif
+#ifdef RECON_HAVE_ZSTD
+        if (zstd_ != nullptr) ZSTD_freeDStream(zstd_);
+#endif
+    }
+
+    // Same contract as ChunkedReader::FillFn.
+    long read(char* out, size_t capacity) {
+        if (!started_ && !start()) return -1;
+        switch (compression_) {
+            case Compression::Gzip: return readGzip(out, capacity);
+            case Compression::Zstd: return readZstd(out, capacity);
+            case Compression::None: break;
+        }
+        return readRaw(out, capacity);
+    }
+
+    Compression compression() const { return compression_; }
+    const std::string& error() const { return error_; }
+
+private:
+    Source source_;
+    std::unique_ptr<char[]> in_;
+    size_t in_capacity_;
+    size_t in_pos_ = 0; // unconsumed input is in_[in_pos_, in_len_)
+    size_t in_len_ = 0;
+    bool started_ = false;
+    bool frame_ended_ = true;
+    Compression compression_ = Compression::None;
+    std::string error_;
+#ifdef RECON_HAVE_ZLIB
+    z_stream gzip_{};
+#endif
+#ifdef RECON_HAVE_ZSTD
+    ZSTD_DStream* zstd_ = nullptr;
+#endif
+
+    long fail(const char* message) {
+        error_ = message;
+        return -1;
+    }
+
+    // Refills the input buffer; returns bytes read, 0 at EOF, -1 on error.
+    long refill() {
+        long n = source_(in_.get(), in_capacity_);
+        in_pos_ = 0;
+        in_len_ = n > 0 ? static_cast<size_t>(n) : 0;
+        if (n < 0) error_ = "read error";
+        return n;
+    }
+
+    bool startFailed(const char* message) {
+        error_ = message;
+        return false;
+    }
+
+    bool start() {
+        started_ = true;
+        // The magic is up to 4 bytes; a pipe may hand out fewer on the first read.
+        while (in_len_ < 4) {
+            long n = source_(in_.get() + in_len_, in_capacity_ - in_len_);
+            if (n < 0) return startFailed("read error");
+            if (n == 0) break;
+            in_len_ += static_cast<size_t>(n);
+        }
+        compression_ = detectCompression(std::string_view(in_.get(), in_len_));
+        switch (compression_) {
+            case Compression::Gzip:
+#ifdef RECON_HAVE_ZLIB
+                // 15 + 32: maximum window, accept both gzip and zlib headers.
+                if (inflateInit2(&gzip_, 15 + 32) != Z_OK) return startFailed("zlib initialisation failed");
+                frame_ended_ = false;
+                return true;
+#else
+                return startFailed("gzip input needs a build with zlib (make ZLIB=1)");
+#endif
+            case Compression::Zstd:
+#ifdef RECON_HAVE_ZSTD
+                zstd_ = ZSTD_createDStream();
+                if (zstd_ == nullptr || ZSTD_isError(ZSTD_initDStream(zstd_))) return startFailed("zstd initialisation failed");
+                frame_ended_ = false;
+                return true;
+#else
+                return startFailed("zstd input needs a build with libzstd (make ZSTD=1)");
+#endif
+            case Compression::None:
+                break;
+        }
+        return true;
+    }
+
+    long readRaw(char* out, size_t capacity) {
+        if (in_pos_ == in_len_) {
+            long n = refill();
+            if (n <= 0) return n;
+        }
+        size_t n = std::min(capacity, in_len_ - in_pos_);
+        std::memcpy(out, in_.get() + in_pos_, n);
+        in_pos_ += n;
+        return static_cast<long>(n);
+    }
+
+    long readGzip(char* out, size_t capacity) {
+#ifdef RECON_HAVE_ZLIB
+        size_t produced = 0;
+        while (produced < capacity) {
+            if (in_pos_ == in_len_) {
+                long n = refill();
+                if (n < 0) return -1;
+                if (n == 0) {
+                    if (!frame_ended_) return fail("truncated gzip stream");
+                    break;
+                }
+            }
+            // Concatenated gzip members (as written by pigz or `cat a.gz b.gz`).
+            if (frame_ended_) {
+                inflateReset(&gzip_);
+                frame_ended_ = false;
+            }
+            // zlib counts in 32-bit uInt: a chunk of 4 GiB or more is filled in
+            // several calls rather than truncating the count.
+            const size_t room = std::min<size_t>(capacity - produced, UINT_MAX);
+            gzip_.next_out = reinterpret_cast<Bytef*>(out + produced);
+            gzip_.avail_out = static_cast<uInt>(room);
+            gzip_.next_in = reinterpret_cast<Bytef*>(in_.get() + in_pos_);
+            gzip_.avail_in = static_cast<uInt>(std::min<size_t>(in_len_ - in_pos_, UINT_MAX));
+            int rc = inflate(&gzip_, Z_NO_FLUSH);
+            in_pos_ = reinterpret_cast<char*>(gzip_.next_in) - in_.get();
+            produced += room - gzip_.avail_out;
+            if (rc == Z_STREAM_END) {
+                frame_ended_ = true;
+            } else if (rc != Z_OK && rc != Z_BUF_ERROR) {
+                return fail("corrupt gzip stream");
+            }
+        }
+        return static_cast<long>(produced);
+#else
+        (void)out;
+        (void)capacity;
+        return fail("gzip support not compiled in");
+#endif
+    }
+
+    long readZstd(char* out, size_t capacity) {
+#ifdef RECON_HAVE_ZSTD
+        ZSTD_outBuffer output = {out, capacity, 0};
+        while (output.pos < output.size) {
+            if (in_pos_ == in_len_) {
+                long n = refill();
+                if (n < 0) return -1;
+                if (n == 0) {
+                    if (!frame_ended_) return fail("truncated zstd stream");
+                    break;
+                }
+            }
+            ZSTD_inBuffer input = {in_.get(), in_len_, in_pos_};
+            size_t rc = ZSTD_decompressStream(zstd_, &output, &input);
+            in_pos_ = input.pos;
+            if (ZSTD_isError(rc)) return fail("corrupt zstd stream");
+            // 0 means a frame just finished; the next one (if any) starts fresh.
+            frame_ended_ = (rc == 0);
+        }
+        return static_cast<long>(output.pos);
+#else
+        (void)out;
+        (void)capacity;
+        return fail("zstd support not compiled in");
+#endif
+    }
+};
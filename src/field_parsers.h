@@ -0,0 +1,298 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+// --- Field Parsers ---
+// Allocation-free, locale-independent converters for the numeric columns of
+// the MBO feed.
+
+// Prices in the feed are fixed-point decimals with 9 fractional digits
+// ("5.510000000"). FixedPrice keeps them as an integer count of 1e-9 units.
+constexpr int64_t kPriceScale = 1000000000;
+constexpr int kPriceDecimals = 9;
+
+struct FixedPrice {
+    int64_t units = 0;
+
+    // Both operands are exact in a double, so the quotient is the correctly
+    // rounded value of the decimal string, i.e. exactly what atof() returns.
+    double toDouble() const { return static_cast<double>(units) / static_cast<double>(kPriceScale); }
+
+    friend bool operator==(FixedPrice a, FixedPrice b) { return a.units == b.units; }
+    friend bool operator!=(FixedPrice a, FixedPrice b) { return a.units != b.units; }
+};
+
+namespace parse_detail {
+
+constexpr int64_t kPow10[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+};
+
+// True if all 8 bytes of `chunk` are ASCII digits.
+inline bool allDigits(uint64_t chunk) {
+    return (((chunk + 0x4646464646464646ULL) | (chunk - 0x3030303030303030ULL)) & 0x8080808080808080ULL) == 0;
+}
+
+// Converts 8 ASCII digits to their value with three multiplies (SWAR),
+// assuming a little-endian load.
+inline uint32_t eightDigits(uint64_t chunk) {
+    chunk -= 0x3030303030303030ULL;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+             (((chunk >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+    return static_cast<uint32_t>(chunk);
+}
+
+} // namespace parse_detail
+
+// Parses a decimal price into 1e-9 units without going through floating
+// point. Digits beyond the ninth decimal are truncated. Returns false (and
+// leaves `out` untouched) on anything other than [-]digits[.digits].
+inline bool parseFixedPrice(std::string_view sv, FixedPrice& out) {
+    const char* p = sv.data();
+    const char* end = p + sv.size();
+    if (p == end) return false;
+
+    bool negative = (*p == '-');
+    if (negative) ++p;
+
+    int64_t whole = 0;
+    const char* digits_begin = p;
+    while (p != end && static_cast<unsigned>(*p - '0') < 10) whole = whole * 10 + (*p++ - '0');
+    bool has_whole = (p != digits_begin);
+
+    int64_t frac = 0;
+    int frac_digits = 0;
+    if (p != end && *p == '.') {
+        ++p;
+        uint64_t chunk;
+        if (end - p >= 8 && (std::memcpy(&chunk, p, 8), parse_detail::allDigits(chunk))) {
+            // Common case: the feed always carries 9 decimals.
+            frac = parse_detail::eightDigits(chunk);
+            frac_digits = 8;
+            p += 8;
+        }
+        for (; p != end && static_cast<unsigned>(*p - '0') < 10; ++p) {
+            if (frac_digits < kPriceDecimals) {
+                frac = frac * 10 + (*p - '0');
+                ++frac_digits;
+            }
+        }
+        if (!has_whole && frac_digits == 0) return false;
+    } else if (!has_whole) {
+        return false;
+    }
+    if (p != end) return false;
+
+    int64_t units = whole * kPriceScale + frac * parse_detail::kPow10[kPriceDecimals - frac_digits];
+    out.units = negative ? -units : units;
+    return true;
+}
+
+// Convenience form for call sites that treat a missing price as zero.
+inline FixedPrice parseFixedPrice(std::string_view sv) {
+    FixedPrice price;
+    parseFixedPrice(sv, price);
+    return price;
+}
+
+// Parses a base-10 integer column (sizes, ids, counters). Like atoll(), it
+// reads an optional sign and the leading run of digits and yields 0 for an
+// empty field, but needs no null-terminated copy.
+inline int64_t parseInteger(std::string_view sv) {
+    const char* p = sv.data();
+    const char* end = p + sv.size();
+    bool negative = (p != end && *p == '-');
+    if (negative || (p != end && *p == '+')) ++p;
+    int64_t value = 0;
+    for (; p != end && static_cast<unsigned>(*p - '0') < 10; ++p) value = value * 10 + (*p - '0');
+    return negative ? -value : value;
+}
+
+// --- Timestamps ---
+// Event times are ISO-8601 UTC strings with nanosecond precision
+// ("2025-07-17T08:05:03.360677248Z"), held internally as int64 nanoseconds
+// since the Unix epoch.
+
+constexpr size_t kTimestampLength = 30; // "YYYY-MM-DDTHH:MM:SS.nnnnnnnnnZ"
+constexpr int64_t kNanosPerSecond = 1000000000;
+
+namespace parse_detail {
+
+// Days since 1970-01-01 of a proleptic Gregorian date (H. Hinnant's algorithm).
+inline int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+inline void civilFromDays(int64_t z, int64_t& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<int64_t>(yoe) + era * 400 + (m <= 2);
+}
+
+inline bool readDigits(const char*& p, const char* end, int count, int64_t& value) {
+    value = 0;
+    for (int i = 0; i < count; ++i, ++p) {
+        if (p == end || static_cast<unsigned>(*p - '0') >= 10) return false;
+        value = value * 10 + (*p - '0');
+    }
+    return true;
+}
+
+inline bool expect(const char*& p, const char* end, char c) {
+    if (p == end || *p != c) return false;
+    ++p;
+    return true;
+}
+
+inline void writeDigits(char* out, uint64_t value, int count) {
+    for (int i = count - 1; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+constexpr uint64_t byteMask(int byte) { return 0xFFULL << (8 * byte); }
+
+inline int64_t twoDigits(const char* p) { return (p[0] - '0') * 10 + (p[1] - '0'); }
+
+// Loads 8 bytes and overwrites the separator bytes at `mask` with '0', so a
+// single allDigits() check validates every digit in the word.
+inline uint64_t loadWithSeparators(const char* p, uint64_t mask) {
+    uint64_t chunk;
+    std::memcpy(&chunk, p, sizeof(chunk));
+    return (chunk & ~mask) | (0x3030303030303030ULL & mask);
+}
+
+// True if the fields are in range. Day 31 is accepted for any month and
+// second 60 for a leap second; neither is checked further.
+inline bool validDateTime(int64_t month, int64_t day, int64_t hour, int64_t minute, int64_t second) {
+    return month >= 1 && month <= 12 && day >= 1 && day <= 31 && hour <= 23 && minute <= 59 && second <= 60;
+}
+
+} // namespace parse_detail
+
+// Fast path for the exact layout the feed uses, "YYYY-MM-DDTHH:MM:SS.nnnnnnnnnZ":
+// fixed offsets, seven separator compares, three SWAR digit checks and one
+// SWAR conversion for the nanoseconds. Returns false for any other layout.
+inline bool parseTimestampFixed(std::string_view sv, int64_t& out) {
+    using namespace parse_detail;
+    if (sv.size() != kTimestampLength) return false;
+    const char* p = sv.data();
+    if (p[4] != '-' || p[7] != '-' || p[10] != 'T' || p[13] != ':' || p[16] != ':' || p[19] != '.' || p[29] != 'Z') {
+        return false;
+    }
+    // Separator byte positions within each 8-byte load (little-endian).
+    constexpr uint64_t kDateMask = byteMask(4) | byteMask(7);    // "YYYY-MM-"
+    constexpr uint64_t kTimeMask = byteMask(2) | byteMask(5);    // "DDTHH:MM"
+    constexpr uint64_t kSecondsMask = byteMask(0) | byteMask(3); // ":SS.nnnn"
+    uint64_t fraction;
+    std::memcpy(&fraction, p + 20, sizeof(fraction));
+    if (!allDigits(loadWithSeparators(p, kDateMask)) || !allDigits(loadWithSeparators(p + 8, kTimeMask)) ||
+        !allDigits(loadWithSeparators(p + 16, kSecondsMask)) || !allDigits(fraction) ||
+        static_cast<unsigned>(p[28] - '0') >= 10) {
+        return false;
+    }
+
+    const int64_t year = twoDigits(p) * 100 + twoDigits(p + 2);
+    const int64_t month = twoDigits(p + 5);
+    const int64_t day = twoDigits(p + 8);
+    const int64_t hour = twoDigits(p + 11);
+    const int64_t minute = twoDigits(p + 14);
+    const int64_t second = twoDigits(p + 17);
+    if (!validDateTime(month, day, hour, minute, second)) return false;
+    const int64_t seconds = hour * 3600 + minute * 60 + second;
+    const int64_t nanos = static_cast<int64_t>(eightDigits(fraction)) * 10 + (p[28] - '0');
+
+    const int64_t days = daysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(day));
+    out = (days * 86400 + seconds) * kNanosPerSecond + nanos;
+    return true;
+}
+
+// Field-by-field parser for "YYYY-MM-DDTHH:MM:SS[.fraction]Z", accepting any
+// fraction length. parseTimestamp() only falls back to it when the fixed
+// path rejects the layout.
+inline bool parseTimestampGeneric(std::string_view sv, int64_t& out) {
+    using namespace parse_detail;
+    const char* p = sv.data();
+    const char* end = p + sv.size();
+    int64_t year, month, day, hour, minute, second;
+    if (!readDigits(p, end, 4, year) || !expect(p, end, '-') ||
+        !readDigits(p, end, 2, month) || !expect(p, end, '-') ||
+        !readDigits(p, end, 2, day) || !expect(p, end, 'T') ||
+        !readDigits(p, end, 2, hour) || !expect(p, end, ':') ||
+        !readDigits(p, end, 2, minute) || !expect(p, end, ':') ||
+        !readDigits(p, end, 2, second)) {
+        return false;
+    }
+    int64_t nanos = 0;
+    if (p != end && *p == '.') {
+        ++p;
+        int digits = 0;
+        for (; p != end && static_cast<unsigned>(*p - '0') < 10; ++p) {
+            if (digits < 9) {
+                nanos = nanos * 10 + (*p - '0');
+                ++digits;
+            }
+        }
+        nanos *= kPow10[9 - digits];
+    }
+    if (p != end && *p == 'Z') ++p;
+    if (p != end || !validDateTime(month, day, hour, minute, second)) return false;
+
+    int64_t days = daysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(day));
+    out = (((days * 24 + hour) * 60 + minute) * 60 + second) * kNanosPerSecond + nanos;
+    return true;
+}
+
+// Parses "YYYY-MM-DDTHH:MM:SS[.fraction]Z" into nanoseconds since the epoch.
+// Fractions shorter than 9 digits are scaled up; the trailing 'Z' is optional.
+inline bool parseTimestamp(std::string_view sv, int64_t& out) {
+    return parseTimestampFixed(sv, out) || parseTimestampGeneric(sv, out);
+}
+
+// Writes `ns` as "YYYY-MM-DDTHH:MM:SS.nnnnnnnnnZ" (kTimestampLength bytes, no
+// terminator) and returns the number of bytes written.
+inline size_t formatTimestamp(int64_t ns, char* out) {
+    using namespace parse_detail;
+    constexpr int64_t kNanosPerDay = 86400 * kNanosPerSecond;
+    int64_t days = ns / kNanosPerDay;
+    int64_t rem = ns % kNanosPerDay;
+    if (rem < 0) {
+        rem += kNanosPerDay;
+        --days;
+    }
+    int64_t year;
+    unsigned month, day;
+    civilFromDays(days, year, month, day);
+    const uint64_t secs = static_cast<uint64_t>(rem / kNanosPerSecond);
+
+    writeDigits(out, static_cast<uint64_t>(year), 4);
+    out[4] = '-';
+    writeDigits(out + 5, month, 2);
+    out[7] = '-';
+    writeDigits(out + 8, day, 2);
+    out[10] = 'T';
+    writeDigits(out + 11, secs / 3600, 2);
+    out[13] = ':';
+    writeDigits(out + 14, (secs / 60) % 60, 2);
+    out[16] = ':';
+    writeDigits(out + 17, secs % 60, 2);
+    out[19] = '.';
+    writeDigits(out + 20, static_cast<uint64_t>(rem % kNanosPerSecond), 9);
+    out[29] = 'Z';
+    return kTimestampLength;
+}
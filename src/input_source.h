@@ -0,0 +1,276 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// --- Input Sources ---
+
+// Read-only view of an input file. By default the file is memory-mapped so the
+// parse loop runs straight over the page cache with no intermediate copy; the
+// old read-into-a-string path is kept for comparison and as a fallback when
+// the input cannot be mapped (pipes, special files).
+class InputFile {
+public:
+    InputFile() = default;
+    InputFile(const InputFile&) = delete;
+    InputFile& operator=(const InputFile&) = delete;
+
+    ~InputFile() {
+        if (mapped_ != nullptr) munmap(mapped_, mapped_size_);
+    }
+
+    bool open(const char* path, bool use_mmap) {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return false;
+        bool ok = open(fd, use_mmap);
+        ::close(fd);
+        return ok;
+    }
+
+    // Maps or reads an already open descriptor; the caller keeps ownership of it.
+    bool open(int fd, bool use_mmap) {
+        struct stat st;
+        if (use_mmap && fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED) {
+                // Input is consumed front to back exactly once: ask the kernel for
+                // aggressive readahead and let it drop pages behind us. Only the
+                // head is prefetched right away, so the first events do not
+                // wait on a page fault, without reading a multi-GB file in
+                // ahead of the parser.
+                madvise(addr, st.st_size, MADV_SEQUENTIAL);
+                madvise(addr, std::min<size_t>(st.st_size, kPrefetchHeadBytes), MADV_WILLNEED);
+                mapped_ = addr;
+                mapped_size_ = st.st_size;
+                view_ = std::string_view(static_cast<const char*>(addr), st.st_size);
+                return true;
+            }
+        }
+        return readAll(fd);
+    }
+
+    std::string_view view() const { return view_; }
+    bool isMapped() const { return mapped_ != nullptr; }
+
+private:
+    // Leading part of a mapped file whose pages are requested up front.
+    static constexpr size_t kPrefetchHeadBytes = size_t(8) << 20;
+
+    void* mapped_ = nullptr;
+    size_t mapped_size_ = 0;
+    std::string owned_;
+    std::string_view view_;
+
+    bool readAll(int fd) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) owned_.reserve(st.st_size);
+        char chunk[1 << 16];
+        ssize_t n;
+        while ((n = ::read(fd, chunk, sizeof(chunk))) != 0) {
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            owned_.append(chunk, n);
+        }
+        view_ = owned_;
+        return true;
+    }
+};
+
+// Reads with read(2), retrying on EINTR. Returns bytes read, 0 at end of
+// input or -1 on error.
+inline long readFd(int fd, char* buffer, size_t capacity) {
+    for (;;) {
+        ssize_t n = ::read(fd, buffer, capacity);
+        if (n >= 0 || errno != EINTR) return static_cast<long>(n);
+    }
+}
+
+// Delivers the input in fixed-size chunks. A background thread fills the next
+// chunk (reading a file, a pipe or stdin, or running a decompressor) while the
+// caller parses the current one. Filled chunks wait in a bounded queue, so
+// memory stays at `buffer_count * chunk_bytes` regardless of input size.
+class ChunkedReader {
+public:
+    // Produces up to `capacity` bytes into `buffer`: the byte count, 0 at end
+    // of input, or -1 on error. Always called on the background thread.
+    using FillFn = std::function<long(char* buffer, size_t capacity)>;
+
+    ChunkedReader(int fd, size_t chunk_bytes, size_t buffer_count = 3)
+        : ChunkedReader([fd](char* buffer, size_t capacity) { return readFd(fd, buffer, capacity); },
+                        chunk_bytes, buffer_count) {}
+
+    ChunkedReader(FillFn fill, size_t chunk_bytes, size_t buffer_count = 3)
+        : fill_(std::move(fill)), chunk_bytes_(chunk_bytes) {
+        for (size_t i = 0; i < buffer_count; ++i) {
+            buffers_.emplace_back(new char[chunk_bytes]);
+            free_.push_back(i);
+        }
+        prefetcher_ = std::thread([this] { prefetchLoop(); });
+    }
+
+    ChunkedReader(const ChunkedReader&) = delete;
+    ChunkedReader& operator=(const ChunkedReader&) = delete;
+
+    ~ChunkedReader() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        prefetcher_.join();
+    }
+
+    // Returns the next chunk in input order, or an empty view at end of input
+    // (check failed() to tell a read error from EOF). The view stays valid
+    // until the following call.
+    std::string_view next() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (current_ != kNone) {
+            free_.push_back(current_);
+            current_ = kNone;
+            cv_.notify_all();
+        }
+        cv_.wait(lock, [this] { return !ready_.empty() || done_; });
+        if (ready_.empty()) return {};
+        auto [index, size] = ready_.front();
+        ready_.pop_front();
+        current_ = index;
+        return std::string_view(buffers_[index].get(), size);
+    }
+
+    bool failed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return error_;
+    }
+
+private:
+    static constexpr size_t kNone = static_cast<size_t>(-1);
+
+    FillFn fill_;
+    size_t chunk_bytes_;
+    std::vector<std::unique_ptr<char[]>> buffers_;
+    std::deque<size_t> free_;
+    std::deque<std::pair<size_t, size_t>> ready_; // (buffer index, bytes)
+    size_t current_ = kNone;
+    bool done_ = false;
+    bool error_ = false;
+    bool stop_ = false;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread prefetcher_;
+
+    void prefetchLoop() {
+        for (;;) {
+            size_t index;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return !free_.empty() || stop_; });
+                if (stop_) return;
+                index = free_.front();
+                free_.pop_front();
+            }
+
+            // Fill the whole chunk: pipes and decompressors hand out data in small pieces.
+            size_t filled = 0;
+            bool eof = false;
+            bool error = false;
+            while (filled < chunk_bytes_) {
+                long n = fill_(buffers_[index].get() + filled, chunk_bytes_ - filled);
+                if (n > 0) {
+                    filled += n;
+                } else {
+                    eof = (n == 0);
+                    error = (n < 0);
+                    break;
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (filled > 0) ready_.emplace_back(index, filled);
+                else free_.push_back(index);
+                if (eof || error) {
+                    done_ = true;
+                    error_ = error;
+                }
+            }
+            cv_.notify_all();
+            if (eof || error) return;
+        }
+    }
+};
+
+// Longest line LineAssembler will carry across a chunk boundary. An MBO
+// CSV line is a few hundred bytes; this only stops a file with no newlines
+// from being buffered whole.
+constexpr size_t kMaxLineBytes = size_t(1) << 20;
+
+// Turns arbitrary chunks into runs of whole lines. Complete lines are passed
+// to the sink straight from the chunk; only the partial line at a chunk
+// boundary is copied, into a carry buffer that is completed from the next
+// chunk. A line longer than `max_line_bytes` stops it with lineTooLong() set.
+class LineAssembler {
+public:
+    explicit LineAssembler(size_t max_line_bytes = kMaxLineBytes) : max_line_bytes_(max_line_bytes) {}
+
+    // `sink(std::string_view lines)` returns false to stop; feed() then does too.
+    template <typename Sink>
+    bool feed(std::string_view chunk, Sink&& sink) {
+        if (!carry_.empty()) {
+            const void* newline = std::memchr(chunk.data(), '\n', chunk.size());
+            if (newline == nullptr) return carry(chunk);
+            size_t head = static_cast<const char*>(newline) - chunk.data() + 1;
+            if (!carry(chunk.substr(0, head))) return false;
+            if (!sink(std::string_view(carry_))) return false;
+            carry_.clear();
+            chunk.remove_prefix(head);
+        }
+
+        const void* last_newline = memrchr(chunk.data(), '\n', chunk.size());
+        if (last_newline == nullptr) return carry(chunk);
+        size_t whole = static_cast<const char*>(last_newline) - chunk.data() + 1;
+        if (!sink(chunk.substr(0, whole))) return false;
+        return carry(chunk.substr(whole));
+    }
+
+    // Flushes a final line that had no trailing newline.
+    template <typename Sink>
+    bool finish(Sink&& sink) {
+        if (carry_.empty()) return true;
+        bool ok = sink(std::string_view(carry_));
+        carry_.clear();
+        return ok;
+    }
+
+    bool lineTooLong() const { return line_too_long_; }
+
+private:
+    std::string carry_;
+    size_t max_line_bytes_;
+    bool line_too_long_ = false;
+
+    bool carry(std::string_view part) {
+        if (carry_.size() + part.size() > max_line_bytes_) {
+            line_too_long_ = true;
+            return false;
+        }
+        carry_.append(part);
+        return true;
+    }
+};
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+
+#include "csv_scanner.h"
+#include "field_parsers.h"
+
+// --- MBO Event Decoding ---
+
+// The subset of an MBO record the book reconstruction needs, decoded once per
+// line. Timestamps are nanoseconds since the epoch and are only turned back
+// into text when a snapshot is written. `symbol` points into the input (or
+// the decoder's symbol table) and is only valid while the event is handled.
+// `flags`, `ts_in_delta` and `sequence` are not used by the book; they are
+// carried through for the vendor MBP-10 rows (--mbp10).
+struct MboEvent {
+    int64_t ts_event = 0;
+    FixedPrice price;
+    long long order_id = 0;
+    int size = 0;
+    char action = 0;
+    char side = 'N';
+    uint8_t flags = 0;
+    uint16_t publisher_id = 0;
+    uint32_t instrument_id = 0;
+    int32_t ts_in_delta = 0;
+    uint32_t sequence = 0;
+    std::string_view symbol;
+};
+
+// Columns of the MBO CSV known to the column plan. The first six are the ones
+// the book needs and must be present; the rest are optional pass-through
+// columns used by tools and richer output formats.
+enum class MboField : uint8_t {
+    TsEvent, Action, Side, Price, Size, OrderId,
+    TsRecv, RType, PublisherId, InstrumentId, ChannelId, Flags, TsInDelta, Sequence, Symbol,
+    Count
+};
+
+constexpr size_t kMboFieldCount = static_cast<size_t>(MboField::Count);
+constexpr size_t kMboRequiredFieldCount = static_cast<size_t>(MboField::TsRecv);
+
+// Header names of the columns, indexed by MboField.
+constexpr std::string_view kMboFieldNames[kMboFieldCount] = {
+    "ts_event", "action", "side", "price", "size", "order_id",
+    "ts_recv", "rtype", "publisher_id", "instrument_id", "channel_id", "flags", "ts_in_delta", "sequence", "symbol",
+};
+
+// Where each column sits in a particular file. Built once from the header
+// line, so exports with reordered or extra columns decode on the same fast
+// path as the standard layout.
+struct MboColumnPlan {
+    static constexpr size_t kNoColumn = static_cast<size_t>(-1);
+
+    size_t column[kMboFieldCount];
+    size_t min_fields = 0; // a record needs at least this many fields to hold every required column
+
+    MboColumnPlan() { std::fill(std::begin(column), std::end(column), kNoColumn); }
+
+    size_t operator[](MboField field) const { return column[static_cast<size_t>(field)]; }
+    bool has(MboField field) const { return (*this)[field] != kNoColumn; }
+
+    // An optional column of `record`, or an empty view if the file or the line lacks it.
+    template <typename Record>
+    std::string_view optional(const Record& record, MboField field) const {
+        size_t index = (*this)[field];
+        return index < record.fieldCount() ? record.field(index) : std::string_view();
+    }
+
+    // Column positions in the standard Databento MBO CSV export.
+    static MboColumnPlan standard() {
+        MboColumnPlan plan;
+        const MboField layout[] = {
+            MboField::TsRecv, MboField::TsEvent, MboField::RType, MboField::PublisherId, MboField::InstrumentId,
+            MboField::Action, MboField::Side, MboField::Price, MboField::Size, MboField::ChannelId,
+            MboField::OrderId, MboField::Flags, MboField::TsInDelta, MboField::Sequence, MboField::Symbol,
+        };
+        for (size_t i = 0; i < std::size(layout); ++i) plan.set(layout[i], i);
+        return plan;
+    }
+
+    // Builds a plan from a header line. On failure returns false and names the
+    // first required column that is missing in `missing`.
+    static bool fromHeader(std::string_view header, MboColumnPlan& plan, std::string_view& missing) {
+        MboColumnPlan result;
+        size_t column = 0;
+        size_t start = 0;
+        while (start <= header.size()) {
+            size_t end = header.find(',', start);
+            if (end == std::string_view::npos) end = header.size();
+            std::string_view name = header.substr(start, end - start);
+            while (!name.empty() && (name.back() == '\r' || name.back() == ' ')) name.remove_suffix(1);
+            while (!name.empty() && name.front() == ' ') name.remove_prefix(1);
+            for (size_t f = 0; f < kMboFieldCount; ++f) {
+                if (result.column[f] == kNoColumn && name == kMboFieldNames[f]) {
+                    result.set(static_cast<MboField>(f), column);
+                }
+            }
+            ++column;
+            start = end + 1;
+        }
+
+        for (size_t f = 0; f < kMboRequiredFieldCount; ++f) {
+            if (result.column[f] == kNoColumn) {
+                missing = kMboFieldNames[f];
+                return false;
+            }
+        }
+        plan = result;
+        return true;
+    }
+
+private:
+    void set(MboField field, size_t index) {
+        column[static_cast<size_t>(field)] = index;
+        if (static_cast<size_t>(field) < kMboRequiredFieldCount && index + 1 > min_fields) min_fields = index + 1;
+    }
+};
+
+// Projects the columns of an mbo.csv line that the book uses into an MboEvent.
+// The structural scanner has already located every delimiter, so unused
+// columns are skipped by index instead of being tokenised, and each projected
+// column is parsed exactly once, in place.
+class MboCsvDecoder {
+public:
+    explicit MboCsvDecoder(const MboColumnPlan& plan = MboColumnPlan::standard()) : plan_(plan) {}
+
+    const MboColumnPlan& plan() const { return plan_; }
+
+    // Returns false for lines that are too short to be an MBO record or whose
+    // timestamp does not parse.
+    bool decode(const CsvRecord& record, MboEvent& event) const {
+        if (record.fieldCount() < plan_.min_fields || record.fieldCount() == 0) return false;
+        const LineFields fields(record);
+        if (!parseTimestamp(fields.field(plan_[MboField::TsEvent]), event.ts_event)) return false;
+
+        event.action = actionCode(fields.field(plan_[MboField::Action]));
+        event.side = sideCode(fields.field(plan_[MboField::Side]));
+        event.order_id = parseInteger(fields.field(plan_[MboField::OrderId]));
+        // The book only reads the price of adds, but MBP-10 rows show it for
+        // every action. A reset has none (an empty field parses as 0).
+        event.price = (event.action != 'R') ? parseFixedPrice(fields.field(plan_[MboField::Price])) : FixedPrice{};
+        event.size = static_cast<int>(parseInteger(fields.field(plan_[MboField::Size])));
+        // Files without these columns hold a single instrument: everything maps to id 0.
+        event.publisher_id = static_cast<uint16_t>(parseInteger(plan_.optional(fields, MboField::PublisherId)));
+        event.instrument_id = static_cast<uint32_t>(parseInteger(plan_.optional(fields, MboField::InstrumentId)));
+        event.flags = static_cast<uint8_t>(parseInteger(plan_.optional(fields, MboField::Flags)));
+        event.ts_in_delta = static_cast<int32_t>(parseInteger(plan_.optional(fields, MboField::TsInDelta)));
+        event.sequence = static_cast<uint32_t>(parseInteger(plan_.optional(fields, MboField::Sequence)));
+        event.symbol = plan_.optional(fields, MboField::Symbol);
+        return true;
+    }
+
+private:
+    MboColumnPlan plan_;
+
+    // The fields of a record, with the '\r' of a CRLF line end stripped once
+    // from the last field, whichever column that is.
+    class LineFields {
+    public:
+        explicit LineFields(const CsvRecord& record)
+            : record_(record), last_(record.fieldCount() - 1), last_field_(record.field(last_)) {
+            if (!last_field_.empty() && last_field_.back() == '\r') last_field_.remove_suffix(1);
+        }
+
+        size_t fieldCount() const { return record_.fieldCount(); }
+        std::string_view field(size_t i) const { return i == last_ ? last_field_ : record_.field(i); }
+
+    private:
+        const CsvRecord& record_;
+        size_t last_;
+        std::string_view last_field_;
+    };
+
+    // Actions are one-letter codes; anything else matches no action.
+    static char actionCode(std::string_view field) {
+        return field.size() == 1 ? field[0] : 0;
+    }
+
+    // An empty side is treated as 'N' (none).
+    static char sideCode(std::string_view field) {
+        return field.empty() ? 'N' : field[0];
+    }
+};
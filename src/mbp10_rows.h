@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string_view>
+
+#include "book_top.h"
+#include "mbo_decoder.h"
+#include "snapshot_format.h"
+
+// --- Vendor MBP-10 rows: the layout of data/mbp.csv, in the same pass ---
+// As in that file, adds, cancels and fills get a row when they touch book
+// level kMbp10LastLevel or better, every reset (including a book's first)
+// gets one, and so does every trade. A trade on a side ('T' with side B
+// or A) is followed by the fill ('F') and cancel ('C') of the resting
+// order it hit; the three become one 'T' row on the resting order's side,
+// showing the book after the fill. Only the filled size leaves the
+// order: the cancel reports the same reduction, not the end of the order.
+// The book must run deeper than the ten levels written so that it sees
+// changes at level 10.
+
+// A book's trade waiting for the fill and cancel that follow it. Each book
+// keeps its own, so events of other instruments arriving in between
+// neither flush it nor get merged into it.
+struct PendingTrade {
+    MboEvent trade;
+    MboEvent fill;
+    bool pending = false;
+    bool filled = false;
+};
+
+// Writes the row of `book`'s pending trade, if any, applying its fill first.
+// Call once per book after the last event.
+template <typename Book, typename RowFn>
+void flushMbp10Trade(Book& book, PendingTrade& pending, RowFn&& row) {
+    if (!pending.pending) return;
+    pending.pending = false;
+    const int depth = pending.filled ? book.apply(pending.fill) : kNoVisibleChange;
+    row(pending.trade, depth == kNoVisibleChange ? 0 : depth);
+}
+
+// Applies `event` to `book` and calls row(event, depth) for each MBP-10 row
+// it produces, once the book shows the row's state. A row can be for an
+// earlier event of the same book: a trade is held back until the events
+// that complete it have arrived.
+template <typename Book, typename RowFn>
+void applyMbp10Event(Book& book, PendingTrade& pending, const MboEvent& event, RowFn&& row) {
+    if (pending.pending) {
+        if (event.action == 'F' && !pending.filled) {
+            pending.fill = event;
+            pending.filled = true;
+            return;
+        }
+        const bool fill_cancel = event.action == 'C' && pending.filled && event.order_id == pending.fill.order_id;
+        flushMbp10Trade(book, pending, row);
+        if (fill_cancel) return;
+    }
+
+    if (event.action == 'T') {
+        if (event.side == 'N') {
+            row(event, 0);
+            return;
+        }
+        pending.trade = event;
+        pending.trade.side = (event.side == 'B') ? 'A' : 'B';
+        pending.trade.symbol = std::string_view(); // not valid past this event; rows use the book's symbol
+        pending.filled = false;
+        pending.pending = true;
+        return;
+    }
+
+    const int depth = book.apply(event);
+    if (event.action == 'R') {
+        row(event, 0);
+    } else if (depth != kNoVisibleChange && depth <= kMbp10LastLevel) {
+        row(event, depth);
+    }
+}
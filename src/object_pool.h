@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// --- Slab object pool ---
+// Hands out default-constructed T from slabs of `kSlabSize` objects. Released
+// objects go on a free list and are reused before a new slab is allocated, so
+// once the pool has grown to the working set there is no heap traffic at all.
+// Addresses stay valid until the object is released or the pool is cleared.
+template <typename T, size_t kSlabSize = 4096>
+class ObjectPool {
+public:
+    T* acquire() {
+        if (free_ != nullptr) {
+            Slot* slot = free_;
+            free_ = slot->next_free;
+            slot->value = T();
+            return &slot->value;
+        }
+        if (used_ == kSlabSize * slabs_.size()) slabs_.emplace_back(new Slot[kSlabSize]);
+        Slot* slot = &slabs_[used_ / kSlabSize][used_ % kSlabSize];
+        ++used_;
+        slot->value = T();
+        return &slot->value;
+    }
+
+    void release(T* object) {
+        Slot* slot = reinterpret_cast<Slot*>(object);
+        slot->next_free = free_;
+        free_ = slot;
+    }
+
+    // Releases every object at once, keeping the slabs for reuse.
+    void clear() {
+        free_ = nullptr;
+        used_ = 0;
+    }
+
+private:
+    // `value` is the first member so a T* converts straight back to its slot.
+    struct Slot {
+        T value;
+        Slot* next_free = nullptr;
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> slabs_;
+    size_t used_ = 0; // slots handed out from the slabs, freed or not
+    Slot* free_ = nullptr;
+};
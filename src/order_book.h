@@ -0,0 +1,228 @@
+#pragma once
+
+#include <string_view>
+#include <functional>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include "book_top.h"
+#include "field_parsers.h"
+#include "mbo_decoder.h"
+#include "order_queues.h"
+#include "order_table.h"
+#include "price_levels.h"
+#include "snapshot_format.h"
+#include "text_format.h"
+
+// --- Price keys ---
+// The book is keyed on PriceTraits<PriceT>::Key. The default is the integer
+// fixed-point value from the parser (1e-9 units): integer compares are cheap
+// and one price string always lands on exactly one level. The double variant
+// is the original representation, kept for benchmarking. Keys are turned
+// back into decimals only when a snapshot is written, by format(), which
+// writes what "%.2f" prints for toDouble().
+template <typename PriceT>
+struct PriceTraits;
+
+template <>
+struct PriceTraits<int64_t> {
+    static int64_t fromFixed(FixedPrice price) { return price.units; }
+    static int64_t fromDouble(double price) { return std::llround(price * kPriceScale); }
+    static double toDouble(int64_t key) { return FixedPrice{key}.toDouble(); }
+    static int64_t toUnits(int64_t key) { return key; }
+    static char* format(char* out, int64_t key) { return formatPrice2(out, FixedPrice{key}); }
+};
+
+template <>
+struct PriceTraits<double> {
+    static double fromFixed(FixedPrice price) { return price.toDouble(); }
+    static double fromDouble(double price) { return price; }
+    static double toDouble(double key) { return key; }
+    static int64_t toUnits(double key) { return std::llround(key * kPriceScale); }
+    static char* format(char* out, double key) { return formatDecimal2(out, key); }
+};
+
+// --- OrderBook Class Definition ---
+// This class encapsulates all the logic for managing the order book.
+// `Levels` is the per-side level container (see price_levels.h) and
+// `Orders` the order store: FlatOrders, or QueuedOrders for L3 queue state.
+// `Depth` is the number of levels per side that snapshots show.
+template <typename PriceT, template <typename, typename> class Levels = MapLevels,
+          template <typename> class Orders = FlatOrders, size_t Depth = 10>
+class BasicOrderBook {
+public:
+    using Price = PriceT;
+    using Traits = PriceTraits<PriceT>;
+    static constexpr size_t kDepth = Depth;
+    // Upper bound on the bytes writeLevels(char*, ...) writes.
+    static constexpr size_t kMaxLevelsBytes = 2 * Depth * (3 + kMaxPriceChars + 2 * kMaxIntegerChars);
+    using BidTop = TopLevels<Price, std::greater<Price>, Depth>;
+    using AskTop = TopLevels<Price, std::less<Price>, Depth>;
+
+    // Represents a single order. Nested struct.
+    struct Order {
+        Price price;
+        int size;
+        char side;
+    };
+
+    explicit BasicOrderBook(const LevelConfig& config = LevelConfig()) : bid_book(config), ask_book(config) {}
+
+    // Every mutation returns the index of the first visible level (0 = best)
+    // it changed on the order's side, or kNoVisibleChange.
+
+    // Processes an 'Add' event with a fixed-point price straight from the parser.
+    int addOrder(long long order_id, FixedPrice price, int size, char side) {
+        return addOrderAt(order_id, Traits::fromFixed(price), size, side);
+    }
+
+    // Processes an 'Add' event with a decimal price.
+    int addOrder(long long order_id, double price, int size, char side) {
+        return addOrderAt(order_id, Traits::fromDouble(price), size, side);
+    }
+
+    // Processes a 'Cancel' event.
+    int cancelOrder(long long order_id) {
+        int depth = kNoVisibleChange;
+        if (Order* ord = order_map.find(order_id)) {
+            depth = updateBook(ord->side, ord->price, -ord->size, -1);
+            order_map.erase(ord);
+        }
+        return depth;
+    }
+
+    // Processes a 'Fill' event.
+    int fillOrder(long long order_id, int size) {
+        if (size <= 0) return kNoVisibleChange;
+        int depth = kNoVisibleChange;
+        if (Order* ord = order_map.find(order_id)) {
+            depth = updateBook(ord->side, ord->price, -size, size >= ord->size ? -1 : 0);
+            ord->size -= size;
+            if (ord->size <= 0) {
+                order_map.erase(ord);
+            }
+        }
+        return depth;
+    }
+
+    // Sizes the order table for `orders` resting orders up front.
+    void reserveOrders(size_t orders) { order_map.reserve(orders); }
+
+    // The visible depth of each side, best level first.
+    const BidTop& topBids() const { return bid_top; }
+    const AskTop& topAsks() const { return ask_top; }
+
+    // The resting orders, e.g. to walk a level's queue in L3 mode.
+    Orders<Order>& orders() { return order_map; }
+    
+    // Applies one decoded MBO event. Trades and unknown actions leave the book unchanged.
+    int apply(const MboEvent& event) {
+        switch (event.action) {
+            case 'A': return addOrder(event.order_id, event.price, event.size, event.side);
+            case 'C': return cancelOrder(event.order_id);
+            case 'F': return fillOrder(event.order_id, event.size);
+            case 'R': return reset();
+            default: return kNoVisibleChange;
+        }
+    }
+
+    // Clears all books; depth 0 changed unless they were already empty.
+    int reset() {
+        const bool was_visible = bid_top.depth() != 0 || ask_top.depth() != 0;
+        order_map.clear();
+        bid_book.clear();
+        ask_book.clear();
+        bid_top.clear();
+        ask_top.clear();
+        return was_visible ? 0 : kNoVisibleChange;
+    }
+
+    // Writes the price, size (and with `with_counts`, order count) columns
+    // of the visible bid levels, then the ask levels, each preceded by a
+    // comma, into `out`, which has room for kMaxLevelsBytes. Returns the end
+    // of the text.
+    char* writeLevels(char* out, bool with_counts = false) const {
+        out = writeSide(out, bid_top, with_counts, std::make_index_sequence<Depth>());
+        return writeSide(out, ask_top, with_counts, std::make_index_sequence<Depth>());
+    }
+
+    // Fills the `Depth` bid and ask levels of a binary snapshot record (see
+    // snapshot_format.h), best first.
+    void writeLevels(SnapshotLevel* bids, SnapshotLevel* asks) const {
+        writeSide(bids, bid_top);
+        writeSide(asks, ask_top);
+    }
+
+private:
+    Orders<Order> order_map;
+    Levels<Price, std::greater<Price>> bid_book;
+    Levels<Price, std::less<Price>> ask_book;
+    // --- Optimization: the visible depth of each side, kept up to date per event ---
+    BidTop bid_top;
+    AskTop ask_top;
+
+    // --- Optimization: one unrolled column writer per level, fixed at compile time ---
+    template <typename Top, size_t... I>
+    static char* writeSide(char* out, const Top& top, bool with_counts, std::index_sequence<I...>) {
+        ((out = writeLevel(out, top, I, with_counts)), ...);
+        return out;
+    }
+
+    template <typename Top>
+    static void writeSide(SnapshotLevel* out, const Top& top) {
+        for (size_t i = 0; i < Depth; ++i) {
+            if (i < top.depth()) {
+                out[i] = SnapshotLevel{Traits::toUnits(top.price(i)), static_cast<uint32_t>(top.total(i).size),
+                                       static_cast<uint32_t>(top.total(i).count)};
+            } else {
+                out[i] = SnapshotLevel{kSnapshotNoPrice, 0, 0};
+            }
+        }
+    }
+
+    // --- Optimization: digits go straight into the row buffer, no stream formatting ---
+    template <typename Top>
+    static char* writeLevel(char* out, const Top& top, size_t i, bool with_counts) {
+        if (i >= top.depth()) {
+            std::memcpy(out, ",,,", 3);
+            return out + (with_counts ? 3 : 2);
+        }
+        *out++ = ',';
+        out = Traits::format(out, top.price(i));
+        *out++ = ',';
+        out = formatInteger(out, top.total(i).size);
+        if (with_counts) {
+            *out++ = ',';
+            out = formatInteger(out, top.total(i).count);
+        }
+        return out;
+    }
+
+    int addOrderAt(long long order_id, Price price, int size, char side) {
+        if (order_id != 0 && size > 0) {
+            order_map.insertOrAssign(order_id, Order{price, size, side});
+            return updateBook(side, price, size, 1);
+        }
+        return kNoVisibleChange;
+    }
+
+    // Adjusts a level's resting size and order count.
+    int updateBook(char side, Price price, int size_diff, int count_diff) {
+        if (side == 'B') {
+            bid_book.add(price, size_diff, count_diff);
+            return bid_top.update(bid_book, price, size_diff, count_diff);
+        } else if (side == 'A') {
+            ask_book.add(price, size_diff, count_diff);
+            return ask_top.update(ask_book, price, size_diff, count_diff);
+        }
+        return kNoVisibleChange;
+    }
+};
+
+// Integer fixed-point price keys (1e-9 units).
+using OrderBook = BasicOrderBook<int64_t>;
+
+// The original double-keyed book.
+using DoubleOrderBook = BasicOrderBook<double>;
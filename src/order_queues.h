@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+#include "object_pool.h"
+#include "order_table.h"
+
+// --- L3 order storage ---
+// Drop-in alternative to OrderTable for the book's order store that also
+// keeps queue priority: every resting order lives in a pooled node linked
+// into the FIFO queue of its price level, oldest first. Nodes and queues
+// come from ObjectPools and the lists are intrusive, so adds, cancels and
+// fills are O(1) with no heap allocation per event. A partial fill keeps
+// the order's place in its queue; re-adding an existing id moves it to the
+// back of its (new) level. A cancel or a fill that ends an order erases it
+// through the id slot find() just located, so, as with OrderTable, the id
+// is probed once.
+//
+// The queues are found through a per-side table keyed by price rather than
+// through the level containers, which stay the same for the aggregate-only
+// book. That is a second hash probe on each add and on each removal that
+// empties a queue (see the README for what it costs).
+//
+// `Order` is the book's order record with `price`, `size` and `side` members;
+// its price type must be integral so it can index the per-side queue tables.
+template <typename Order>
+class QueuedOrders {
+public:
+    using Price = decltype(Order::price);
+    static_assert(std::is_integral<Price>::value, "QueuedOrders needs integer price keys");
+
+    // The slot found is remembered, so that erasing the same order right
+    // after (a cancel, or a fill that ends it) needs no second probe.
+    Order* find(long long order_id) {
+        found_slot_ = by_id_.find(order_id);
+        return found_slot_ != nullptr ? &(*found_slot_)->order : nullptr;
+    }
+
+    Order& insertOrAssign(long long order_id, const Order& order) {
+        found_slot_ = nullptr; // inserting can move slots
+        auto [slot, inserted] = by_id_.findOrInsert(order_id);
+        if (inserted) {
+            *slot = nodes_.acquire();
+            (*slot)->id = order_id;
+        } else {
+            unlink(*slot);
+        }
+        Node* node = *slot;
+        node->order = order;
+        link(node);
+        return node->order;
+    }
+
+    // Removes the order `found` points to (as returned by find()).
+    void erase(Order* found) {
+        Node* node = reinterpret_cast<Node*>(found);
+        unlink(node);
+        Node** slot = (found_slot_ != nullptr && *found_slot_ == node) ? found_slot_ : by_id_.find(node->id);
+        found_slot_ = nullptr; // erasing shifts slots back
+        by_id_.erase(slot);
+        nodes_.release(node);
+    }
+
+    void reserve(size_t orders) {
+        found_slot_ = nullptr;
+        by_id_.reserve(orders);
+    }
+
+    void clear() {
+        found_slot_ = nullptr;
+        by_id_.clear();
+        bid_queues_.clear();
+        ask_queues_.clear();
+        nodes_.clear();
+        queues_.clear();
+    }
+
+    size_t size() const { return by_id_.size(); }
+
+    // Calls f(order_id, order) for each order resting at `price` on `side`,
+    // front of the queue first.
+    template <typename F>
+    void forEachInQueue(char side, Price price, F&& f) {
+        QueueTable* table = queuesFor(side);
+        Queue** queue = table != nullptr ? table->find(static_cast<long long>(price)) : nullptr;
+        if (queue == nullptr) return;
+        for (const Node* node = (*queue)->head; node != nullptr; node = node->next) f(node->id, node->order);
+    }
+
+private:
+    struct Queue;
+
+    // `order` is the first member so an Order* converts straight back to its node.
+    struct Node {
+        Order order;
+        long long id = 0;
+        Node* prev = nullptr;
+        Node* next = nullptr;
+        Queue* queue = nullptr;
+    };
+
+    // Price -> queue; no real price is the minimum 64-bit value.
+    using QueueTable = OrderTable<Queue*, std::numeric_limits<long long>::min()>;
+
+    struct Queue {
+        Node* head = nullptr;
+        Node* tail = nullptr;
+        Price price = 0;
+        QueueTable* table = nullptr; // the side's table that indexes this queue
+    };
+
+    OrderTable<Node*> by_id_;
+    Node** found_slot_ = nullptr; // by_id_ slot of the last find(), until the table next changes
+    QueueTable bid_queues_;
+    QueueTable ask_queues_;
+    ObjectPool<Node> nodes_;
+    ObjectPool<Queue> queues_;
+
+    QueueTable* queuesFor(char side) {
+        if (side == 'B') return &bid_queues_;
+        if (side == 'A') return &ask_queues_;
+        return nullptr;
+    }
+
+    // Appends `node` to the queue for its order's side and price. Orders
+    // with no book side are tracked by id only.
+    void link(Node* node) {
+        node->prev = node->next = nullptr;
+        node->queue = nullptr;
+        QueueTable* table = queuesFor(node->order.side);
+        if (table == nullptr) return;
+        const long long key = static_cast<long long>(node->order.price);
+        auto [slot, inserted] = table->findOrInsert(key);
+        if (inserted) {
+            *slot = queues_.acquire();
+            (*slot)->price = node->order.price;
+            (*slot)->table = table;
+        }
+        Queue* queue = *slot;
+        node->queue = queue;
+        node->prev = queue->tail;
+        if (queue->tail != nullptr) queue->tail->next = node;
+        else queue->head = node;
+        queue->tail = node;
+    }
+
+    // Takes `node` out of its queue, dropping the queue once it is empty.
+    void unlink(Node* node) {
+        Queue* queue = node->queue;
+        if (queue == nullptr) return;
+        if (node->prev != nullptr) node->prev->next = node->next;
+        else queue->head = node->next;
+        if (node->next != nullptr) node->next->prev = node->prev;
+        else queue->tail = node->prev;
+        node->queue = nullptr;
+        if (queue->head == nullptr) {
+            queue->table->erase(queue->table->find(static_cast<long long>(queue->price)));
+            queues_.release(queue);
+        }
+    }
+};
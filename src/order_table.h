@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// --- Open-addressing order table ---
+// Resting orders keyed by exchange order id, in one flat array of slots with
+// linear probing. Compared with std::unordered_map there is no node per
+// order and no bucket indirection: a lookup is a hash, a multiply-shift and
+// usually a single cache line. find() returns a pointer to the slot's value
+// that erase() accepts directly, so cancel-and-remove costs one probe.
+// Erasure shifts the following entries of the cluster back instead of
+// leaving tombstones, so probe lengths do not degrade over a long session.
+// `kEmpty` is reserved as the empty-slot marker and must not be inserted;
+// the default suits order ids, as the book never stores order id 0.
+template <typename Value, long long kEmpty = 0>
+class OrderTable {
+public:
+    using Key = long long;
+
+    OrderTable() { allocate(kMinCapacity); }
+
+    // Pointer to the value stored under `key`, or nullptr. `kEmpty` itself is
+    // never stored, so it is not found (rather than matching an empty slot).
+    Value* find(Key key) {
+        if (key == kEmpty) return nullptr;
+        for (size_t i = home(key);; i = (i + 1) & mask_) {
+            if (slots_[i].key == key) return &slots_[i].value;
+            if (slots_[i].key == kEmpty) return nullptr;
+        }
+    }
+
+    // Stores `value` under `key`, replacing any existing value.
+    Value& insertOrAssign(Key key, const Value& value) {
+        if ((size_ + 1) * kMaxLoadDen > capacity() * kMaxLoadNum) allocate(capacity() * 2);
+        return place(key, value);
+    }
+
+    // Finds `key`, inserting a default value if it is missing, in one probe
+    // sequence. The flag is true if the entry was inserted.
+    std::pair<Value*, bool> findOrInsert(Key key) {
+        if ((size_ + 1) * kMaxLoadDen > capacity() * kMaxLoadNum) allocate(capacity() * 2);
+        size_t i = home(key);
+        while (slots_[i].key != kEmpty && slots_[i].key != key) i = (i + 1) & mask_;
+        if (slots_[i].key == key) return {&slots_[i].value, false};
+        ++size_;
+        slots_[i].key = key;
+        slots_[i].value = Value();
+        return {&slots_[i].value, true};
+    }
+
+    // Removes the entry whose value `found` points to (as returned by find()).
+    void erase(Value* found) {
+        Slot* hole = reinterpret_cast<Slot*>(reinterpret_cast<char*>(found) - offsetof(Slot, value));
+        size_t i = static_cast<size_t>(hole - slots_.get());
+        // Backward-shift deletion: pull later entries of the cluster into the
+        // hole unless that would move them in front of their home slot.
+        for (size_t j = (i + 1) & mask_; slots_[j].key != kEmpty; j = (j + 1) & mask_) {
+            size_t h = home(slots_[j].key);
+            if (((j - h) & mask_) >= ((j - i) & mask_)) {
+                slots_[i] = slots_[j];
+                i = j;
+            }
+        }
+        slots_[i].key = kEmpty;
+        --size_;
+    }
+
+    // Grows the table so `count` entries fit without rehashing.
+    void reserve(size_t count) {
+        size_t capacity = this->capacity();
+        while (count * kMaxLoadDen > capacity * kMaxLoadNum) capacity *= 2;
+        if (capacity != this->capacity()) allocate(capacity);
+    }
+
+    void clear() {
+        for (size_t i = 0; i <= mask_; ++i) slots_[i].key = kEmpty;
+        size_ = 0;
+    }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Slot {
+        Key key;
+        Value value;
+    };
+
+    static constexpr size_t kMinCapacity = 64;
+    // Maximum load factor 7/10.
+    static constexpr size_t kMaxLoadNum = 7;
+    static constexpr size_t kMaxLoadDen = 10;
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_ = 0;
+    unsigned shift_ = 64;
+    size_t size_ = 0;
+
+    // Exchange ids are often sequential; Fibonacci hashing spreads them out.
+    size_t home(Key key) const {
+        return static_cast<size_t>((static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+
+    Value& place(Key key, const Value& value) {
+        size_t i = home(key);
+        while (slots_[i].key != kEmpty && slots_[i].key != key) i = (i + 1) & mask_;
+        if (slots_[i].key == kEmpty) ++size_;
+        slots_[i].key = key;
+        slots_[i].value = value;
+        return slots_[i].value;
+    }
+
+    // Moves every entry into a fresh array of `capacity` slots (a power of two).
+    void allocate(size_t capacity) {
+        std::unique_ptr<Slot[]> old = std::move(slots_);
+        const size_t old_capacity = old ? this->capacity() : 0;
+        slots_.reset(new Slot[capacity]());
+        mask_ = capacity - 1;
+        shift_ = 64 - static_cast<unsigned>(__builtin_ctzll(capacity));
+        clear();
+        for (size_t i = 0; i < old_capacity; ++i) {
+            if (old[i].key != kEmpty) place(old[i].key, old[i].value);
+        }
+    }
+};
+
+// The book's default order store: orders by id, with no queue priority.
+template <typename Order>
+using FlatOrders = OrderTable<Order>;
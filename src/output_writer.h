@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+
+// --- Output Sink ---
+
+// Writes with write(2) until all `size` bytes are out, retrying on EINTR.
+// Returns false on error (see errno).
+inline bool writeFd(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Writes output to a file descriptor on a background thread. The caller
+// formats into the current buffer; once it is full it is queued for the
+// writer thread and the caller carries on in a free one, so disk writes
+// overlap with producing the next rows. Memory stays at
+// `buffer_count * buffer_bytes` regardless of how much is written.
+class BackgroundWriter {
+public:
+    BackgroundWriter(int fd, size_t buffer_bytes, size_t buffer_count = 2)
+        : fd_(fd), buffers_(std::max<size_t>(buffer_count, 2), std::vector<char>(buffer_bytes)) {
+        for (size_t i = 1; i < buffers_.size(); ++i) free_.push_back(i);
+        writer_ = std::thread([this] { writeLoop(); });
+    }
+
+    BackgroundWriter(const BackgroundWriter&) = delete;
+    BackgroundWriter& operator=(const BackgroundWriter&) = delete;
+
+    ~BackgroundWriter() { finish(); }
+
+    // Room for `bytes` more output, valid until commit(). A request larger
+    // than a whole buffer grows that buffer.
+    char* reserve(size_t bytes) {
+        if (used_ + bytes > buffers_[current_].size()) {
+            submit();
+            if (bytes > buffers_[current_].size()) buffers_[current_].resize(bytes);
+        }
+        return buffers_[current_].data() + used_;
+    }
+
+    // Appends the first `bytes` of the space returned by reserve().
+    void commit(size_t bytes) { used_ += bytes; }
+
+    // Writes out the rest and stops the writer thread. Returns false if any
+    // write failed (see error()).
+    bool finish() {
+        if (writer_.joinable()) {
+            submit();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            cv_.notify_all();
+            writer_.join();
+        }
+        return error_.empty();
+    }
+
+    const std::string& error() const { return error_; }
+
+private:
+    int fd_;
+    std::vector<std::vector<char>> buffers_;
+    size_t current_ = 0; // the buffer being filled
+    size_t used_ = 0;
+    std::deque<size_t> free_;
+    std::deque<std::pair<size_t, size_t>> ready_; // (buffer index, bytes)
+    bool stop_ = false;
+    std::string error_; // set by the writer thread, read after it has stopped
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread writer_;
+
+    // Queues the current buffer and switches to a free one, waiting for the
+    // writer thread if none is free.
+    void submit() {
+        if (used_ == 0) return;
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.emplace_back(current_, used_);
+        cv_.notify_all();
+        cv_.wait(lock, [this] { return !free_.empty(); });
+        current_ = free_.front();
+        free_.pop_front();
+        used_ = 0;
+    }
+
+    void writeLoop() {
+        for (;;) {
+            std::pair<size_t, size_t> buffer;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return !ready_.empty() || stop_; });
+                if (ready_.empty()) return;
+                buffer = ready_.front();
+                ready_.pop_front();
+            }
+
+            // After a failed write the rest is dropped, but buffers keep
+            // cycling so the producer never blocks.
+            if (error_.empty() && !writeFd(fd_, buffers_[buffer.first].data(), buffer.second)) {
+                error_ = std::strerror(errno);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                free_.push_back(buffer.first);
+            }
+            cv_.notify_all();
+        }
+    }
+};
@@ -0,0 +1,275 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <type_traits>
+#include <vector>
+
+// --- Price level containers ---
+// One side of the aggregated book: price -> total resting size and order
+// count, ordered so that the best price comes first. `Better(a, b)` is true when price `a` is
+// better than `b` (std::greater for bids, std::less for asks). Every
+// container offers the same small interface so OrderBook can be
+// instantiated with any of them:
+//   add(price, size_diff, count_diff)  adjust a level, dropping it once its size is <= 0
+//   forEachBest(n, f)                  call f(price, size, count) for the best n levels
+//   clear()
+
+// Settings for containers that need to know about the instrument.
+struct LevelConfig {
+    int64_t tick = 10000000; // TickLadder tick size in price units (0.01 at 1e-9 units)
+    size_t ladder_ticks = 4096; // TickLadder window width, a multiple of 64
+};
+
+// Resting size and number of orders at one price.
+struct LevelTotal {
+    int size = 0;
+    int count = 0;
+};
+
+// Node-based levels: O(log n) updates anywhere in the book.
+template <typename Price, typename Better>
+class MapLevels {
+public:
+    explicit MapLevels(const LevelConfig& = LevelConfig()) {}
+
+    void add(Price price, int size_diff, int count_diff) {
+        LevelTotal& level = levels_[price];
+        level.size += size_diff;
+        level.count += count_diff;
+        if (level.size <= 0) levels_.erase(price);
+    }
+
+    template <typename F>
+    void forEachBest(size_t n, F&& f) const {
+        for (auto it = levels_.begin(); n != 0 && it != levels_.end(); ++it, --n) {
+            f(it->first, it->second.size, it->second.count);
+        }
+    }
+
+    void clear() { levels_.clear(); }
+    size_t size() const { return levels_.size(); }
+
+private:
+    std::map<Price, LevelTotal, Better> levels_;
+};
+
+// Levels in one contiguous sorted vector, worst price first and best price
+// at the back. Activity clusters around the touch, so a lookup walks a few
+// levels back from the end before falling back to binary search, and
+// inserting or erasing near the touch only shifts the few levels behind it.
+// The top of book is a linear read backwards from the end.
+template <typename Price, typename Better>
+class VectorLevels {
+public:
+    explicit VectorLevels(const LevelConfig& = LevelConfig()) {}
+
+    void add(Price price, int size_diff, int count_diff) {
+        auto it = position(price);
+        if (it != levels_.end() && it->price == price) {
+            it->size += size_diff;
+            it->count += count_diff;
+            if (it->size <= 0) levels_.erase(it);
+        } else if (size_diff > 0) {
+            levels_.insert(it, Level{price, size_diff, count_diff});
+        }
+    }
+
+    template <typename F>
+    void forEachBest(size_t n, F&& f) const {
+        for (auto it = levels_.rbegin(); n != 0 && it != levels_.rend(); ++it, --n) f(it->price, it->size, it->count);
+    }
+
+    void clear() { levels_.clear(); }
+    size_t size() const { return levels_.size(); }
+
+private:
+    struct Level {
+        Price price;
+        int size;
+        int count;
+    };
+
+    // Levels scanned linearly from the touch before switching to binary search.
+    static constexpr int kLinearLevels = 8;
+
+    std::vector<Level> levels_;
+
+    // First level that is not worse than `price`, i.e. where `price` lives or would be inserted.
+    typename std::vector<Level>::iterator position(Price price) {
+        Better better;
+        auto it = levels_.end();
+        for (int i = 0; i < kLinearLevels; ++i) {
+            if (it == levels_.begin() || better(price, (it - 1)->price)) return it;
+            --it;
+        }
+        return std::lower_bound(levels_.begin(), it, price,
+                                [&better](const Level& level, Price p) { return better(p, level.price); });
+    }
+};
+
+// Dense tick ladder for integer prices: a window of `ladder_ticks` price
+// slots indexed by tick offset, plus a bitmap of the non-empty slots. Slot 0
+// is the best end of the window for either side, so an update is an array
+// index and the top of book comes from count-trailing-zeros over the bitmap.
+// A price outside the window re-centers it when everything resting still
+// fits; otherwise (and for prices off the tick grid) the level goes to an
+// overflow map that is merged in when the top of book is read.
+template <typename Price, typename Better>
+class TickLadder {
+    static_assert(std::is_integral<Price>::value, "TickLadder needs integer price keys");
+
+public:
+    explicit TickLadder(const LevelConfig& config = LevelConfig())
+        : tick_(config.tick), levels_(config.ladder_ticks), bits_(config.ladder_ticks / 64) {}
+
+    void add(Price price, int size_diff, int count_diff) {
+        size_t slot;
+        if (!slotOf(price, slot) && (size_diff <= 0 || !recenter(price) || !slotOf(price, slot))) {
+            addOverflow(price, size_diff, count_diff);
+            return;
+        }
+        LevelTotal& level = levels_[slot];
+        if (level.size == 0) {
+            if (size_diff <= 0) return;
+            level = LevelTotal{size_diff, count_diff};
+            bits_[slot / 64] |= uint64_t(1) << (slot % 64);
+            ++occupied_;
+            return;
+        }
+        level.size += size_diff;
+        level.count += count_diff;
+        if (level.size <= 0) {
+            level = LevelTotal();
+            bits_[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+            --occupied_;
+        }
+    }
+
+    template <typename F>
+    void forEachBest(size_t n, F&& f) const {
+        Better better;
+        size_t slot = nextSlot(0);
+        auto it = overflow_.begin();
+        for (; n != 0; --n) {
+            if (slot < levels_.size() && (it == overflow_.end() || better(priceOf(slot), it->first))) {
+                f(priceOf(slot), levels_[slot].size, levels_[slot].count);
+                slot = nextSlot(slot + 1);
+            } else if (it != overflow_.end()) {
+                f(it->first, it->second.size, it->second.count);
+                ++it;
+            } else {
+                break;
+            }
+        }
+    }
+
+    void clear() {
+        std::fill(levels_.begin(), levels_.end(), LevelTotal());
+        std::fill(bits_.begin(), bits_.end(), 0);
+        overflow_.clear();
+        occupied_ = 0;
+    }
+
+    size_t size() const { return occupied_ + overflow_.size(); }
+
+    // Levels held in the overflow map rather than the window.
+    size_t overflowSize() const { return overflow_.size(); }
+
+private:
+    // Bids count ticks downwards from the window's base so slot 0 is always the best end.
+    static constexpr bool kDescending = Better()(Price(1), Price(0));
+
+    int64_t tick_;
+    int64_t base_ = 0; // rank of slot 0
+    std::vector<LevelTotal> levels_;
+    std::vector<uint64_t> bits_;
+    size_t occupied_ = 0; // non-empty slots
+    std::map<Price, LevelTotal, Better> overflow_;
+
+    // Tick rank of an on-grid price; lower ranks are better.
+    int64_t rankOf(Price price) const { return (kDescending ? -int64_t(price) : int64_t(price)) / tick_; }
+
+    Price priceOf(size_t slot) const {
+        int64_t rank = base_ + static_cast<int64_t>(slot);
+        return static_cast<Price>((kDescending ? -rank : rank) * tick_);
+    }
+
+    bool slotOf(Price price, size_t& slot) const {
+        if (price % tick_ != 0) return false;
+        int64_t offset = rankOf(price) - base_;
+        if (offset < 0 || offset >= static_cast<int64_t>(levels_.size())) return false;
+        slot = static_cast<size_t>(offset);
+        return true;
+    }
+
+    // First occupied slot at or after `from`, or levels_.size() if none.
+    size_t nextSlot(size_t from) const {
+        size_t word = from / 64;
+        if (word >= bits_.size()) return levels_.size();
+        uint64_t bits = bits_[word] & (~uint64_t(0) << (from % 64));
+        while (bits == 0) {
+            if (++word == bits_.size()) return levels_.size();
+            bits = bits_[word];
+        }
+        return word * 64 + static_cast<size_t>(__builtin_ctzll(bits));
+    }
+
+    // Last occupied slot; only called while occupied_ != 0.
+    size_t lastSlot() const {
+        size_t word = bits_.size() - 1;
+        while (bits_[word] == 0) --word;
+        return word * 64 + 63 - static_cast<size_t>(__builtin_clzll(bits_[word]));
+    }
+
+    void addOverflow(Price price, int size_diff, int count_diff) {
+        LevelTotal& level = overflow_[price];
+        level.size += size_diff;
+        level.count += count_diff;
+        if (level.size <= 0) overflow_.erase(price);
+    }
+
+    // Moves the window so that `price` and every occupied slot fit, centred.
+    // Returns false if they span more than the window.
+    bool recenter(Price price) {
+        if (price % tick_ != 0) return false;
+        const int64_t width = static_cast<int64_t>(levels_.size());
+        int64_t low = rankOf(price);
+        int64_t high = low;
+        if (occupied_ != 0) {
+            low = std::min(low, base_ + static_cast<int64_t>(nextSlot(0)));
+            high = std::max(high, base_ + static_cast<int64_t>(lastSlot()));
+        }
+        if (high - low + 1 > width) return false;
+
+        std::vector<std::pair<int64_t, LevelTotal>> resting;
+        resting.reserve(occupied_);
+        for (size_t slot = nextSlot(0); slot < levels_.size(); slot = nextSlot(slot + 1)) {
+            resting.emplace_back(base_ + static_cast<int64_t>(slot), levels_[slot]);
+            levels_[slot] = LevelTotal();
+        }
+        std::fill(bits_.begin(), bits_.end(), 0);
+        base_ = low - (width - (high - low + 1)) / 2;
+        for (const auto& [rank, level] : resting) {
+            size_t slot = static_cast<size_t>(rank - base_);
+            levels_[slot] = level;
+            bits_[slot / 64] |= uint64_t(1) << (slot % 64);
+        }
+
+        // Overflow levels that the new window covers move into it.
+        for (auto it = overflow_.begin(); it != overflow_.end();) {
+            size_t slot;
+            if (slotOf(it->first, slot)) {
+                levels_[slot] = it->second;
+                bits_[slot / 64] |= uint64_t(1) << (slot % 64);
+                ++occupied_;
+                it = overflow_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        return true;
+    }
+};
@@ -1,223 +1,695 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <string>
 #include <string_view>
 #include <vector>
-#include <map>
-#include <unordered_map>
-#include <iomanip>
-#include <cstdlib> // For atof, atoll, atoi
-
-// --- OrderBook Class Definition ---
-// This class encapsulates all the logic for managing the order book.
-class OrderBook {
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <memory>
+#include <type_traits>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "csv_front_end.h"
+#include "csv_scanner.h"
+#include "dbn.h"
+#include "decompress.h"
+#include "book_manager.h"
+#include "input_source.h"
+#include "mbp10_rows.h"
+#include "mbo_decoder.h"
+#include "order_book.h"
+#include "output_writer.h"
+#include "snapshot_format.h"
+#include "text_format.h"
+
+// --- Utility and Main Functions ---
+
+// Peak resident set size of this process in kilobytes.
+long peakRssKb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// Output goes to the writer thread in buffers of this size, two of them.
+constexpr size_t kOutputBufferBytes = 1 << 22;
+
+// Default chunk size for --stream.
+constexpr size_t kDefaultChunkBytes = 1 << 22;
+
+// Largest --parse-threads accepted.
+constexpr size_t kMaxParseThreads = 256;
+
+// Largest --keyframe-interval accepted.
+constexpr size_t kMaxKeyframeInterval = 1000000000;
+
+// Largest --chunk-size accepted. The streaming reader holds three chunks.
+constexpr size_t kMaxChunkBytes = size_t(4) << 30;
+
+// The order table is pre-sized for one resting order per this many input
+// bytes (a DBN MBO record is 56 bytes, a CSV line longer), up to a cap, so
+// it does not rehash in the middle of a session.
+constexpr size_t kInputBytesPerOrderHint = 64;
+constexpr size_t kMaxOrderReserve = size_t(1) << 20;
+
+// Applies decoded MBO events to their instrument's book and formats one
+// snapshot row per event into the output writer's buffers.
+template <typename Book>
+class Reconstructor final : public EventSink {
 public:
-    // Represents a single order. Nested struct.
-    struct Order {
-        double price;
-        int size;
-        char side;
+    Reconstructor(BackgroundWriter& out, const LevelConfig& levels, const SnapshotFormat& format,
+                  std::chrono::steady_clock::time_point start_time)
+        : books_(levels), out_(out), format_(format), start_time_(start_time) {
+        if (format_.binary) {
+            const SnapshotFileHeader header = makeSnapshotFileHeader(Book::kDepth);
+            std::memcpy(out_.reserve(sizeof(header)), &header, sizeof(header));
+            out_.commit(sizeof(header));
+            return;
+        }
+        const std::string header = format_.mbp10    ? mbp10CsvHeader()
+                                   : format_.deltas ? deltaCsvHeader(Book::kDepth, format_.with_counts)
+                                                    : snapshotCsvHeader(Book::kDepth, format_);
+        std::memcpy(out_.reserve(header.size()), header.data(), header.size());
+        out_.commit(header.size());
+    }
+
+    void onEvents(const MboEvent* events, size_t count) override {
+        for (size_t i = 0; i < count; ++i) onEvent(events[i]);
+    }
+
+    void reserveFor(size_t input_bytes) override {
+        books_.reserveOrders(std::min(input_bytes / kInputBytesPerOrderHint, kMaxOrderReserve));
+    }
+
+    void finish() override {
+        if (!format_.mbp10) return;
+        for (size_t i = 0; i < books_.size(); ++i) {
+            auto& entry = books_[i];
+            flushMbp10Trade(entry.book, entry.state.trade,
+                            [&](const MboEvent& row, int depth) { writeMbp10Row(entry, row, depth); });
+        }
+    }
+
+    double firstEventMs() const override { return first_event_ms_; }
+
+private:
+    // Longest row apart from the symbol: timestamp, depth, levels and separators.
+    static constexpr size_t kMaxRowBytes = kTimestampLength + 1 + kMaxIntegerChars + Book::kMaxLevelsBytes + 2;
+
+    // With --deltas: the levels of each book's previous line, and how many
+    // lines ago its last keyframe was. With --mbp10: its pending trade.
+    struct BookState {
+        SnapshotLevel bids[Book::kDepth];
+        SnapshotLevel asks[Book::kDepth];
+        int64_t ts_event = 0;
+        size_t lines_since_keyframe = 0;
+        PendingTrade trade;
     };
+    using Books = BookManager<Book, BookState>;
+
+    Books books_;
+    BackgroundWriter& out_;
+    SnapshotFormat format_;
+    std::chrono::steady_clock::time_point start_time_;
+    double first_event_ms_ = -1.0;
 
-    // Processes an 'Add' event.
-    void addOrder(long long order_id, double price, int size, char side) {
-        if (order_id != 0 && size > 0) {
-            order_map[order_id] = {price, size, side};
-            updateBook(side, price, size);
+    // With --mbp10: the number of the next row.
+    uint64_t mbp10_rows_ = 0;
+
+    void onEvent(const MboEvent& event) {
+        auto& entry = books_.bookFor(event);
+        if (format_.mbp10) {
+            applyMbp10Event(entry.book, entry.state.trade, event,
+                            [&](const MboEvent& row, int depth) { writeMbp10Row(entry, row, depth); });
+            return;
         }
+        // Each book's initial clear ('R') produces no snapshot.
+        const bool first_event = !entry.started;
+        entry.started = true;
+        if (first_event && event.action == 'R') return;
+
+        // --- Optimization: events that leave the visible depth alone need no new row ---
+        const int depth = entry.book.apply(event);
+        if (format_.skip_unchanged && depth == kNoVisibleChange) return;
+
+        if (format_.binary) {
+            // --- Binary output: one fixed-size record per snapshot, no text at all ---
+            SnapshotRecord<Book::kDepth> record;
+            record.head = SnapshotRecordHead{event.ts_event, event.instrument_id, depth};
+            entry.book.writeLevels(record.bids, record.asks);
+            std::memcpy(out_.reserve(sizeof(record)), &record, sizeof(record));
+            out_.commit(sizeof(record));
+        } else if (format_.deltas) {
+            writeDeltaRow(entry, event.ts_event, depth);
+        } else {
+            writeCsvRow(entry, event.ts_event, depth);
+        }
+        noteFirstRow();
     }
 
-    // Processes a 'Cancel' event.
-    void cancelOrder(long long order_id) {
-        if (order_map.count(order_id)) {
-            const auto& ord = order_map.at(order_id);
-            updateBook(ord.side, ord.price, -ord.size);
-            order_map.erase(order_id);
+    void noteFirstRow() {
+        if (first_event_ms_ < 0) {
+            first_event_ms_ = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start_time_).count();
         }
     }
 
-    // Processes a 'Fill' event.
-    void fillOrder(long long order_id, int size) {
-        if (order_map.count(order_id) && size > 0) {
-            auto& ord = order_map.at(order_id);
-            updateBook(ord.side, ord.price, -size);
-            ord.size -= size;
-            if (ord.size <= 0) {
-                order_map.erase(order_id);
+    // --- Vendor MBP-10 rows (see mbp10_rows.h) ---
+    void writeMbp10Row(const typename Books::Entry& entry, const MboEvent& event, int depth) {
+        SnapshotLevel bids[Book::kDepth];
+        SnapshotLevel asks[Book::kDepth];
+        entry.book.writeLevels(bids, asks);
+        char* const row = out_.reserve(maxMbp10CsvBytes() + entry.symbol.size());
+        out_.commit(writeMbp10Csv(row, mbp10_rows_++, event, depth, bids, asks, entry.symbol) - row);
+        noteFirstRow();
+    }
+
+    // --- Delta output: only the levels that changed, with periodic keyframes ---
+    void writeDeltaRow(typename Books::Entry& entry, int64_t ts_event, int depth) {
+        BookState& state = entry.state;
+        const bool keyframe = state.lines_since_keyframe == 0;
+        state.lines_since_keyframe = (state.lines_since_keyframe + 1) % format_.keyframe_interval;
+
+        SnapshotLevel bids[Book::kDepth];
+        SnapshotLevel asks[Book::kDepth];
+        entry.book.writeLevels(bids, asks);
+
+        char* const row = out_.reserve(maxDeltaCsvBytes(Book::kDepth) + entry.symbol.size());
+        char* out = row;
+        if (keyframe) {
+            out += formatTimestamp(ts_event, out);
+        } else {
+            const int64_t gap = ts_event - state.ts_event;
+            *out++ = gap < 0 ? '-' : '+';
+            out = formatUnsigned(out, gap < 0 ? 0 - static_cast<uint64_t>(gap) : static_cast<uint64_t>(gap));
+        }
+        *out++ = ',';
+        out = formatUnsigned(out, entry.index);
+        if (keyframe) {
+            std::memcpy(out, ",K,", 3);
+            out += 3;
+            std::memcpy(out, entry.symbol.data(), entry.symbol.size());
+            out += entry.symbol.size();
+            for (const SnapshotLevel& level : bids) out = writeLevelCsv(out, level, format_.with_counts);
+            for (const SnapshotLevel& level : asks) out = writeLevelCsv(out, level, format_.with_counts);
+        } else {
+            std::memcpy(out, ",D", 2);
+            out += 2;
+            // Levels above the first changed one are as they were. Only a
+            // reset touches the other side, and it reports depth 0.
+            if (depth != kNoVisibleChange) {
+                out = writeDeltaCsv(out, 'B', state.bids, bids, Book::kDepth, depth, format_.with_counts);
+                out = writeDeltaCsv(out, 'A', state.asks, asks, Book::kDepth, depth, format_.with_counts);
             }
         }
+        *out++ = '\n';
+        out_.commit(out - row);
+        state.ts_event = ts_event;
+        std::memcpy(state.bids, bids, sizeof(bids));
+        std::memcpy(state.asks, asks, sizeof(asks));
     }
-    
-    // Clears all books.
-    void reset() {
-        order_map.clear();
-        bid_book.clear();
-        ask_book.clear();
+
+    void writeCsvRow(const typename Books::Entry& entry, int64_t ts_event, int depth) {
+        // --- Optimization: rows are formatted straight into the writer's buffer ---
+        char* const row = out_.reserve(kMaxRowBytes + entry.symbol.size());
+        char* out = row + formatTimestamp(ts_event, row);
+        if (format_.with_depth) {
+            *out++ = ',';
+            if (depth != kNoVisibleChange) out = formatInteger(out, depth);
+        }
+        out = entry.book.writeLevels(out, format_.with_counts);
+        if (format_.with_symbol) {
+            *out++ = ',';
+            std::memcpy(out, entry.symbol.data(), entry.symbol.size());
+            out += entry.symbol.size();
+        }
+        *out++ = '\n';
+        out_.commit(out - row);
     }
+};
 
-    // Writes a snapshot of the book to a stringstream.
-    void writeSnapshot(std::stringstream& oss, std::string_view ts) const {
-        oss << ts;
-        int count = 0;
-        for (const auto& [price, size] : bid_book) {
-            if (count >= 10) break;
-            oss << "," << std::fixed << std::setprecision(2) << price << "," << size;
-            count++;
+// Routes raw input chunks to the CSV or DBN decoder, picked from the first
+// bytes of the stream (DBN files start with the "DBN" magic).
+class InputDecoder {
+public:
+    InputDecoder(ScanKernel kernel, size_t parse_threads, EventSink& sink)
+        : csv_(kernel, parse_threads, sink), sink_(sink) {}
+
+    bool feed(std::string_view chunk) {
+        if (format_ == Format::Unknown) {
+            // Wait for enough bytes to recognise the magic.
+            if (prefix_.empty() && chunk.size() >= sizeof(kDbnMagic)) {
+                format_ = isDbn(chunk) ? Format::Dbn : Format::Csv;
+            } else {
+                prefix_.append(chunk);
+                if (prefix_.size() < sizeof(kDbnMagic)) return true;
+                format_ = isDbn(prefix_) ? Format::Dbn : Format::Csv;
+                std::string head;
+                head.swap(prefix_);
+                return feedDecoder(head);
+            }
         }
-        for (int i = count; i < 10; ++i) oss << ",,";
+        return feedDecoder(chunk);
+    }
 
-        count = 0;
-        for (const auto& [price, size] : ask_book) {
-            if (count >= 10) break;
-            oss << "," << std::fixed << std::setprecision(2) << price << "," << size;
-            count++;
+    bool finish() {
+        if (format_ == Format::Unknown) {
+            format_ = Format::Csv;
+            std::string head;
+            head.swap(prefix_);
+            if (!feedDecoder(head)) return false;
         }
-        for (int i = count; i < 10; ++i) oss << ",,";
-        oss << "\n";
+        if (format_ == Format::Dbn) {
+            if (!dbn_.finish()) {
+                std::cerr << "Error: " << dbn_.error() << "\n";
+                return false;
+            }
+            return true;
+        }
+        return lines_.finish([this](std::string_view lines) { return csv_.consume(lines); });
     }
 
+    bool isDbnInput() const { return format_ == Format::Dbn; }
+
 private:
-    std::unordered_map<long long, Order> order_map;
-    std::map<double, int, std::greater<double>> bid_book;
-    std::map<double, int> ask_book;
+    enum class Format { Unknown, Csv, Dbn };
+
+    CsvFrontEnd csv_;
+    LineAssembler lines_;
+    DbnDecoder dbn_;
+    EventSink& sink_;
+    std::vector<MboEvent> events_;
+    Format format_ = Format::Unknown;
+    std::string prefix_;
+
+    bool feedDecoder(std::string_view chunk) {
+        if (format_ == Format::Csv) {
+            if (lines_.feed(chunk, [this](std::string_view lines) { return csv_.consume(lines); })) return true;
+            if (lines_.lineTooLong()) {
+                std::cerr << "Error: Input has a line longer than " << (kMaxLineBytes >> 20) << " MB.\n";
+            }
+            return false;
+        }
 
-    void updateBook(char side, double price, int size_diff) {
-        if (side == 'B') {
-            bid_book[price] += size_diff;
-            if (bid_book[price] <= 0) bid_book.erase(price);
-        } else if (side == 'A') {
-            ask_book[price] += size_diff;
-            if (ask_book[price] <= 0) ask_book.erase(price);
+        // --- DBN: records map straight onto MboEvent, no text parsing ---
+        // Decoded a block at a time, so a mapped file is not buffered as events all at once.
+        bool ok = true;
+        while (ok && !chunk.empty()) {
+            std::string_view block = chunk.substr(0, kScanBlockBytes);
+            chunk.remove_prefix(block.size());
+            events_.clear();
+            ok = dbn_.feed(block, [this](const MboEvent& event) { events_.push_back(event); });
+            sink_.onEvents(events_.data(), events_.size());
         }
+        if (!ok) std::cerr << "Error: " << dbn_.error() << "\n";
+        return ok;
     }
 };
 
+// Parses a decimal count of at most `limit`; 0 on error, including values
+// above `limit`. Digits are checked against the limit as they accumulate,
+// so no input can overflow.
+size_t parseCount(std::string_view text, size_t limit) {
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string_view::npos) return 0;
+    size_t count = 0;
+    for (char digit : text) {
+        count = count * 10 + static_cast<size_t>(digit - '0');
+        if (count > limit) return 0;
+    }
+    return count;
+}
 
-// --- Utility and Main Functions ---
-
-// Fast, lightweight CSV string splitter.
-std::vector<std::string_view> splitString(std::string_view s, char delimiter) {
-    std::vector<std::string_view> tokens;
-    size_t start = 0;
-    size_t end = s.find(delimiter);
-    while (end != std::string_view::npos) {
-        tokens.push_back(s.substr(start, end - start));
-        start = end + 1;
-        end = s.find(delimiter, start);
-    }
-    tokens.push_back(s.substr(start));
-    return tokens;
+// Parses a byte count with an optional K, M or G suffix; 0 on error,
+// including values above `limit`.
+size_t parseByteSize(std::string_view text, size_t limit) {
+    size_t multiplier = 1;
+    if (!text.empty()) {
+        switch (text.back()) {
+            case 'K': case 'k': multiplier = size_t(1) << 10; break;
+            case 'M': case 'm': multiplier = size_t(1) << 20; break;
+            case 'G': case 'g': multiplier = size_t(1) << 30; break;
+            default: break;
+        }
+        if (multiplier != 1) text.remove_suffix(1);
+    }
+    return parseCount(text, limit / multiplier) * multiplier;
 }
 
-// Helper to convert a string_view to a number without heap allocation.
-// Uses a stack buffer to create a temporary null-terminated string.
-template<typename T>
-T sv_to_num(std::string_view sv) {
-    if (sv.empty()) return 0;
-    char buf[32]; // Stack buffer, sufficient for prices/sizes/ids
-    if (sv.length() >= sizeof(buf)) return 0; // Avoid overflow
-    sv.copy(buf, sv.length());
-    buf[sv.length()] = '\0';
-
-    if constexpr (std::is_same_v<T, double>) return atof(buf);
-    if constexpr (std::is_same_v<T, long long>) return atoll(buf);
-    if constexpr (std::is_same_v<T, int>) return atoi(buf);
-    return 0;
+void printUsage() {
+    std::cerr << "Usage: ./reconstruction [options] <input_path | ->\n"
+              << "  The input is MBO data as CSV or as DBN binary, optionally gzip or zstd compressed\n"
+              << "  (all detected from the input's magic bytes).\n"
+              << "  --read             copy the whole file into memory instead of memory-mapping it\n"
+              << "  --stream           read the input in fixed-size chunks on a background thread\n"
+              << "                     (implied for stdin ('-'), pipes and other non-regular files)\n"
+              << "  --chunk-size=SIZE  chunk size for --stream, e.g. 512K or 8M (default 4M, at most 4G);\n"
+              << "                     input memory is bounded by three chunks\n"
+              << "  --parse-threads=N  decode CSV on N threads, then apply the events in order (default 1)\n"
+              << "  --stats            print time-to-first-event and peak RSS to stderr\n"
+              << "  --scanner=KIND     delimiter scanner: auto (default), avx2, sse2 or scalar\n"
+              << "  --price-keys=KIND  book price keys: fixed (integer 1e-9 units, default) or double\n"
+              << "  --levels=KIND      price level container: map (default), vector or ladder\n"
+              << "  --tick-size=PRICE  tick size for --levels=ladder (default 0.01)\n"
+              << "  --depth=N          levels per side in each snapshot: 1, 5, 10 (default), 20 or 50\n"
+              << "  --counts           add each level's order count (bid_ct_N, ask_ct_N) to the output\n"
+              << "  --depth-column     add a depth column: the first visible level the event changed\n"
+              << "  --skip-unchanged   only write a row when the event changed the visible levels\n"
+              << "  --symbol-column    add a symbol column naming each row's instrument\n"
+              << "  --binary           write fixed-size binary records to output/mbp_output.bin instead of CSV\n"
+              << "                     (always with counts, changed depth and instrument id; see mbp_to_csv)\n"
+              << "  --deltas           write only the changed levels per row to output/mbp_deltas.csv, with a\n"
+              << "                     full keyframe every N rows per book (--keyframe-interval=N, default 1000;\n"
+              << "                     see deltas_to_csv)\n"
+              << "  --mbp10            write the vendor MBP-10 layout of data/mbp.csv to output/mbp_output.csv\n"
+              << "  --l3               keep every order in its price level's FIFO queue (needs fixed price keys)\n";
 }
 
+// Which price representation the book is keyed on.
+enum class PriceKeys { Fixed, Double };
 
-int main(int argc, char* argv[]) {
-    std::ios_base::sync_with_stdio(false);
+// Which container holds each side's price levels (see price_levels.h).
+enum class LevelStore { Map, Vector, Ladder };
 
-    if (argc < 2) {
-        std::cerr << "Usage: ./reconstruction <input_csv_path>\n";
-        return 1;
-    }
+// Command-line settings.
+struct Options {
+    bool use_mmap = true;
+    bool use_stream = false;
+    size_t chunk_bytes = kDefaultChunkBytes;
+    bool print_stats = false;
+    size_t parse_threads = 1;
+    ScanKernel scan_kernel = ScanKernel::Auto;
+    PriceKeys price_keys = PriceKeys::Fixed;
+    LevelStore levels = LevelStore::Map;
+    LevelConfig level_config;
+    size_t depth = 10;
+    bool l3 = false;
+    SnapshotFormat format;
+    const char* input_path = nullptr;
+    std::chrono::steady_clock::time_point start_time;
+};
 
-    // --- Optimization: Read entire file into memory at once ---
-    std::ifstream fin(argv[1], std::ios::binary | std::ios::ate);
-    if (!fin.is_open()) {
-        std::cerr << "Error: Could not open input file " << argv[1] << "\n";
-        return 1;
+
+// Picks the snapshot depth for a book keyed on `Price` with the given level
+// container and order store. Each depth is its own instantiation, so only
+// the production configurations get all of them: the double keys and the
+// vector container are benchmark baselines and stay at depth 10 (checked in
+// main()), which keeps the build time in check.
+template <typename Price, template <typename, typename> class Levels, template <typename> class Orders>
+std::unique_ptr<EventSink> makeWithLevels(const Options& options, BackgroundWriter& out) {
+    auto make = [&](auto depth) -> std::unique_ptr<EventSink> {
+        using Book = BasicOrderBook<Price, Levels, Orders, decltype(depth)::value>;
+        return std::make_unique<Reconstructor<Book>>(out, options.level_config, options.format, options.start_time);
+    };
+    constexpr bool kAllDepths = std::is_integral<Price>::value && !std::is_same<Levels<Price, std::less<Price>>,
+                                                                                VectorLevels<Price, std::less<Price>>>::value;
+    if constexpr (kAllDepths) {
+        // --mbp10 writes 10 levels but also reports changes at level 10, one
+        // below them, so it runs the 20-level book.
+        switch (options.format.mbp10 ? 20 : options.depth) {
+            case 1: return make(std::integral_constant<size_t, 1>());
+            case 5: return make(std::integral_constant<size_t, 5>());
+            case 20: return make(std::integral_constant<size_t, 20>());
+            case 50: return make(std::integral_constant<size_t, 50>());
+            default: break;
+        }
     }
-    std::streamsize size = fin.tellg();
-    fin.seekg(0, std::ios::beg);
-    std::string file_buffer(size, '\0');
-    if (!fin.read(file_buffer.data(), size)) {
-        std::cerr << "Error: Could not read file into buffer.\n";
-        return 1;
+    return make(std::integral_constant<size_t, 10>());
+}
+
+// Picks the level container for a book keyed on `Price` with order store
+// `Orders`. The ladder needs integer keys (checked in main()).
+template <typename Price, template <typename> class Orders>
+std::unique_ptr<EventSink> makeWithOrders(const Options& options, BackgroundWriter& out) {
+    if (options.levels == LevelStore::Vector) return makeWithLevels<Price, VectorLevels, Orders>(options, out);
+    if constexpr (std::is_integral<Price>::value) {
+        if (options.levels == LevelStore::Ladder) return makeWithLevels<Price, TickLadder, Orders>(options, out);
     }
-    fin.close();
+    return makeWithLevels<Price, MapLevels, Orders>(options, out);
+}
 
-    OrderBook book;
-    std::stringstream output_buffer;
+// Builds the reconstructor for the book type `options` asks for. L3 queues
+// need integer keys (checked in main()).
+std::unique_ptr<EventSink> makeReconstructor(const Options& options, BackgroundWriter& out) {
+    if (options.price_keys == PriceKeys::Double) return makeWithOrders<double, FlatOrders>(options, out);
+    if (options.l3) return makeWithOrders<int64_t, QueuedOrders>(options, out);
+    return makeWithOrders<int64_t, FlatOrders>(options, out);
+}
 
-    output_buffer << "ts_event";
-    for (int i = 0; i < 10; ++i) output_buffer << ",bid_price_" << i << ",bid_size_" << i;
-    for (int i = 0; i < 10; ++i) output_buffer << ",ask_price_" << i << ",ask_size_" << i;
-    output_buffer << "\n";
+// Reconstructs the book from the input named in `options` into
+// output/mbp_output.csv, output/mbp_output.bin with --binary or
+// output/mbp_deltas.csv with --deltas.
+int run(const Options& options) {
+    bool use_stream = options.use_stream;
+    const bool from_stdin = std::string_view(options.input_path) == "-";
 
-    // --- Optimization: Process the in-memory buffer ---
-    std::string_view file_view(file_buffer);
-    size_t start_pos = 0;
-    
-    // Skip header line
-    size_t first_newline = file_view.find('\n');
-    if (first_newline != std::string_view::npos) {
-        start_pos = first_newline + 1;
+    // The input is opened once, before the output is touched, so a mistyped
+    // path leaves the output of an earlier run alone. Nothing reads it ahead
+    // of the decoder, which matters for pipes, FIFOs and process substitution.
+    const int in_fd = from_stdin ? STDIN_FILENO : ::open(options.input_path, O_RDONLY);
+    if (in_fd < 0) {
+        std::cerr << "Error: Could not open input file " << options.input_path << "\n";
+        return 1;
+    }
+    struct stat input_stat;
+    const bool regular_file = ::fstat(in_fd, &input_stat) == 0 && S_ISREG(input_stat.st_mode);
+    // Anything but a regular file is streamed: it cannot be mapped, and
+    // reading all of it first would not bound memory.
+    if (!regular_file) use_stream = true;
+    InputFile input;
+    if (!use_stream && !input.open(in_fd, options.use_mmap)) {
+        std::cerr << "Error: Could not read input file " << options.input_path << "\n";
+        if (!from_stdin) ::close(in_fd);
+        return 1;
     }
+    // Compressed files cannot be parsed in place. Their codec is sniffed from
+    // the bytes already in memory, as the decoder sniffs DBN, and they are
+    // decompressed from there on the streaming reader's background thread.
+    const bool inflate_view = !use_stream && detectCompression(input.view()) != Compression::None;
 
-    bool is_first_event = true;
+    // Rows go to a temporary file that replaces the output only once the
+    // whole input has been decoded, so an unreadable or corrupt input does
+    // not wipe it either.
+    const char* output_path = options.format.binary   ? "output/mbp_output.bin"
+                              : options.format.deltas ? "output/mbp_deltas.csv"
+                                                      : "output/mbp_output.csv";
+    const std::string temp_path = std::string(output_path) + ".tmp";
+    const int out_fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out_fd < 0) {
+        std::cerr << "Error: Could not open output file " << temp_path << ". Make sure the 'output' directory exists.\n";
+        if (!from_stdin) ::close(in_fd);
+        return 1;
+    }
+    // --- Bounded output memory: rows are written on a background thread ---
+    BackgroundWriter writer(out_fd, kOutputBufferBytes);
+    std::unique_ptr<EventSink> sink = makeReconstructor(options, writer);
+    EventSink& reconstructor = *sink;
+    InputDecoder decoder(options.scan_kernel, options.parse_threads, reconstructor);
+    const char* input_mode = "mmap";
+    Compression compression = Compression::None;
+    bool ok = true;
 
-    while (start_pos < file_view.size()) {
-        size_t end_pos = file_view.find('\n', start_pos);
-        if (end_pos == std::string_view::npos) {
-            end_pos = file_view.size();
+    if (use_stream || inflate_view) {
+        // --- Bounded memory: stream fixed-size chunks, prefetching the next one ---
+        if (regular_file) reconstructor.reserveFor(input_stat.st_size);
+        DecodingStream::Source source;
+        if (inflate_view) {
+            source = [view = input.view()](char* buffer, size_t capacity) mutable -> long {
+                size_t n = std::min(capacity, view.size());
+                std::memcpy(buffer, view.data(), n);
+                view.remove_prefix(n);
+                return static_cast<long>(n);
+            };
+        } else {
+            source = [in_fd](char* buffer, size_t capacity) { return readFd(in_fd, buffer, capacity); };
         }
-        std::string_view line = file_view.substr(start_pos, end_pos - start_pos);
-        start_pos = end_pos + 1;
-
-        if (line.empty()) continue;
+        {
+            // --- Compressed input: decompression runs on the prefetch thread ---
+            DecodingStream stream(std::move(source));
+            ChunkedReader reader([&stream](char* buffer, size_t capacity) { return stream.read(buffer, capacity); },
+                                 options.chunk_bytes);
+            for (std::string_view chunk = reader.next(); ok && !chunk.empty(); chunk = reader.next()) {
+                ok = decoder.feed(chunk);
+            }
+            const bool read_failed = reader.failed();
+            ok = ok && !read_failed && decoder.finish();
+            if (stream.compression() != Compression::None) compression = stream.compression();
+            if (read_failed) {
+                std::cerr << "Error: Could not read input " << options.input_path << ": " << stream.error() << "\n";
+            }
+        }
+        if (use_stream) input_mode = "stream";
+        else if (!input.isMapped()) input_mode = "read";
+    } else {
+        // --- Optimization: Map the input instead of copying it into a buffer ---
+        reconstructor.reserveFor(input.view().size());
+        ok = decoder.feed(input.view()) && decoder.finish();
+        if (!input.isMapped()) input_mode = "read";
+    }
+    if (!from_stdin) ::close(in_fd);
+    if (ok) reconstructor.finish();
 
-        std::vector<std::string_view> buffer = splitString(line, ',');
-        if (buffer.size() < 11) continue;
+    const bool written = writer.finish();
+    ::close(out_fd);
+    if (ok && !written) std::cerr << "Error: Could not write " << temp_path << ": " << writer.error() << "\n";
+    if (!ok || !written) {
+        ::unlink(temp_path.c_str());
+        return 1;
+    }
+    if (::rename(temp_path.c_str(), output_path) != 0) {
+        std::cerr << "Error: Could not replace " << output_path << ": " << std::strerror(errno) << "\n";
+        ::unlink(temp_path.c_str());
+        return 1;
+    }
 
-        std::string_view ts = buffer[1];
-        std::string_view action = buffer[5];
-        
-        if (is_first_event && action == "R") {
-            is_first_event = false;
-            continue;
-        }
-        is_first_event = false;
+    if (options.print_stats) {
+        double total_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - options.start_time).count();
+        std::cerr << "input mode: " << input_mode << (decoder.isDbnInput() ? " (dbn" : " (csv")
+                  << (compression != Compression::None ? std::string(", ") + compressionName(compression) : "") << ")\n"
+                  << "time to first event: " << reconstructor.firstEventMs() << " ms\n"
+                  << "total time: " << total_ms << " ms\n"
+                  << "peak RSS: " << peakRssKb() << " KB\n";
+    }
 
-        char side = buffer[6].empty() ? 'N' : buffer[6][0];
-        long long oid = sv_to_num<long long>(buffer[10]);
+    return 0;
+}
 
-        if (action == "R") {
-            book.reset();
-        } else if (action == "A") {
-            double price = sv_to_num<double>(buffer[7]);
-            int size = sv_to_num<int>(buffer[8]);
-            book.addOrder(oid, price, size, side);
-        } else if (action == "C") {
-            book.cancelOrder(oid);
-        } else if (action == "F") {
-            int size = sv_to_num<int>(buffer[8]);
-            book.fillOrder(oid, size);
+int main(int argc, char* argv[]) {
+    std::ios_base::sync_with_stdio(false);
+    Options options;
+    options.start_time = std::chrono::steady_clock::now();
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg(argv[i]);
+        if (arg == "--read") {
+            options.use_mmap = false;
+        } else if (arg == "--stream") {
+            options.use_stream = true;
+        } else if (arg.substr(0, 13) == "--chunk-size=") {
+            options.chunk_bytes = parseByteSize(arg.substr(13), kMaxChunkBytes);
+            if (options.chunk_bytes == 0) {
+                std::cerr << "Error: Invalid chunk size " << arg.substr(13) << " (at most 4G)\n";
+                return 1;
+            }
+        } else if (arg.substr(0, 16) == "--parse-threads=") {
+            options.parse_threads = parseCount(arg.substr(16), kMaxParseThreads);
+            if (options.parse_threads == 0) {
+                std::cerr << "Error: Invalid thread count " << arg.substr(16) << " (use 1 to "
+                          << kMaxParseThreads << ")\n";
+                return 1;
+            }
+        } else if (arg == "--counts") {
+            options.format.with_counts = true;
+        } else if (arg == "--depth-column") {
+            options.format.with_depth = true;
+        } else if (arg == "--symbol-column") {
+            options.format.with_symbol = true;
+        } else if (arg == "--binary") {
+            options.format.binary = true;
+        } else if (arg == "--deltas") {
+            options.format.deltas = true;
+        } else if (arg == "--mbp10") {
+            options.format.mbp10 = true;
+        } else if (arg.substr(0, 20) == "--keyframe-interval=") {
+            options.format.keyframe_interval = parseCount(arg.substr(20), kMaxKeyframeInterval);
+            if (options.format.keyframe_interval == 0) {
+                std::cerr << "Error: Invalid keyframe interval " << arg.substr(20) << " (use 1 to "
+                          << kMaxKeyframeInterval << ")\n";
+                return 1;
+            }
+        } else if (arg == "--skip-unchanged") {
+            options.format.skip_unchanged = true;
+        } else if (arg == "--l3") {
+            options.l3 = true;
+        } else if (arg == "--stats") {
+            options.print_stats = true;
+        } else if (arg.substr(0, 10) == "--scanner=") {
+            std::string_view kind = arg.substr(10);
+            if (kind == "auto") options.scan_kernel = ScanKernel::Auto;
+            else if (kind == "avx2") options.scan_kernel = ScanKernel::Avx2;
+            else if (kind == "sse2") options.scan_kernel = ScanKernel::Sse2;
+            else if (kind == "scalar") options.scan_kernel = ScanKernel::Scalar;
+            else {
+                std::cerr << "Error: Unknown scanner " << kind << "\n";
+                return 1;
+            }
+        } else if (arg.substr(0, 13) == "--price-keys=") {
+            std::string_view kind = arg.substr(13);
+            if (kind == "fixed") options.price_keys = PriceKeys::Fixed;
+            else if (kind == "double") options.price_keys = PriceKeys::Double;
+            else {
+                std::cerr << "Error: Unknown price keys " << kind << "\n";
+                return 1;
+            }
+        } else if (arg.substr(0, 9) == "--levels=") {
+            std::string_view kind = arg.substr(9);
+            if (kind == "map") options.levels = LevelStore::Map;
+            else if (kind == "vector") options.levels = LevelStore::Vector;
+            else if (kind == "ladder") options.levels = LevelStore::Ladder;
+            else {
+                std::cerr << "Error: Unknown level container " << kind << "\n";
+                return 1;
+            }
+        } else if (arg.substr(0, 8) == "--depth=") {
+            std::string_view depth = arg.substr(8);
+            if (depth != "1" && depth != "5" && depth != "10" && depth != "20" && depth != "50") {
+                std::cerr << "Error: Unsupported depth " << depth << " (use 1, 5, 10, 20 or 50)\n";
+                return 1;
+            }
+            options.depth = static_cast<size_t>(parseInteger(depth));
+        } else if (arg.substr(0, 12) == "--tick-size=") {
+            FixedPrice tick;
+            if (!parseFixedPrice(arg.substr(12), tick) || tick.units <= 0) {
+                std::cerr << "Error: Invalid tick size " << arg.substr(12) << "\n";
+                return 1;
+            }
+            options.level_config.tick = tick.units;
+        } else if (arg == "-" || arg.empty() || arg[0] != '-') {
+            options.input_path = argv[i];
+        } else {
+            std::cerr << "Error: Unknown option " << arg << "\n";
+            printUsage();
+            return 1;
         }
-        
-        book.writeSnapshot(output_buffer, ts);
     }
 
-    std::ofstream fout("output/mbp_output.csv");
-    if (!fout.is_open()) {
-        std::cerr << "Error: Could not open output file output/mbp_output.csv. Make sure the 'output' directory exists.\n";
+    if (options.input_path == nullptr) {
+        printUsage();
         return 1;
     }
-    fout << output_buffer.rdbuf();
-    fout.close();
 
-    return 0;
-}
\ No newline at end of file
+    if (options.price_keys == PriceKeys::Double && options.l3) {
+        std::cerr << "Error: --l3 needs --price-keys=fixed\n";
+        return 1;
+    }
+    if (options.price_keys == PriceKeys::Double && options.levels == LevelStore::Ladder) {
+        std::cerr << "Error: --levels=ladder needs --price-keys=fixed\n";
+        return 1;
+    }
+    if (options.format.binary && options.format.deltas) {
+        std::cerr << "Error: --binary and --deltas cannot be combined\n";
+        return 1;
+    }
+    if (options.depth != 10 && (options.price_keys == PriceKeys::Double || options.levels == LevelStore::Vector)) {
+        std::cerr << "Error: --depth other than 10 needs --price-keys=fixed and --levels=map or ladder\n";
+        return 1;
+    }
+    if (options.format.mbp10) {
+        const SnapshotFormat& format = options.format;
+        if (format.binary || format.deltas || format.with_counts || format.with_depth || format.with_symbol ||
+            format.skip_unchanged || options.depth != 10) {
+            std::cerr << "Error: --mbp10 has a fixed layout and cannot be combined with other output flags or --depth\n";
+            return 1;
+        }
+        if (options.price_keys == PriceKeys::Double || options.levels == LevelStore::Vector) {
+            std::cerr << "Error: --mbp10 needs --price-keys=fixed and --levels=map or ladder\n";
+            return 1;
+        }
+    }
+
+    return run(options);
+}
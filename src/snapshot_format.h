@@ -0,0 +1,498 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "field_parsers.h"
+#include "mbo_decoder.h"
+#include "text_format.h"
+
+// --- Snapshot Output Formats ---
+// Snapshots are written as CSV rows (output/mbp_output.csv) or, with
+// --binary, as fixed-size binary records (output/mbp_output.bin) that
+// downstream jobs can mmap as an array of structs instead of re-parsing text.
+// --deltas and --mbp10 write the delta and vendor MBP-10 CSVs described below.
+
+// With --deltas, every book writes a full keyframe at most this many rows apart.
+constexpr size_t kDefaultKeyframeInterval = 1000;
+
+// Which optional columns the snapshot rows carry, and which rows are written.
+struct SnapshotFormat {
+    bool with_counts = false; // bid_ct_N / ask_ct_N after each level
+    bool with_depth = false; // `depth` column: first visible level the event changed
+    bool skip_unchanged = false; // no row for events that leave the visible depth as it was
+    bool with_symbol = false; // trailing `symbol` column naming the row's instrument
+    bool binary = false; // binary records instead of CSV rows
+    bool deltas = false; // changed levels only, with periodic keyframes
+    bool mbp10 = false; // the vendor's MBP-10 layout instead of the columns above
+    size_t keyframe_interval = kDefaultKeyframeInterval; // rows per book between keyframes
+};
+
+// The CSV header line (with its newline) for `depth` levels per side.
+inline std::string snapshotCsvHeader(size_t depth, const SnapshotFormat& format) {
+    std::string header = "ts_event";
+    if (format.with_depth) header += ",depth";
+    for (const char* side : {"bid", "ask"}) {
+        for (size_t i = 0; i < depth; ++i) {
+            const std::string level = std::to_string(i);
+            header += std::string(",") + side + "_price_" + level + "," + side + "_size_" + level;
+            if (format.with_counts) header += std::string(",") + side + "_ct_" + level;
+        }
+    }
+    if (format.with_symbol) header += ",symbol";
+    return header + "\n";
+}
+
+// --- Binary snapshots ---
+// A SnapshotFileHeader, then one record per snapshot: a SnapshotRecordHead
+// followed by `depth` bid levels and `depth` ask levels, best first. Every
+// field is naturally aligned and stored in host byte order, which is
+// little-endian on all supported targets. Prices are integers in units of
+// 1/price_scale; a level that does not exist has price kSnapshotNoPrice and
+// zero size and count.
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "binary snapshots are little-endian; this target is not"
+#endif
+
+constexpr char kSnapshotMagic[4] = {'M', 'B', 'P', 'S'};
+constexpr uint16_t kSnapshotVersion = 1;
+constexpr int64_t kSnapshotNoPrice = std::numeric_limits<int64_t>::max();
+
+struct SnapshotFileHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t depth; // levels per side in each record
+    uint32_t header_bytes; // records start at this offset
+    uint32_t record_bytes;
+    int64_t price_scale; // price units per 1.0
+    int64_t no_price; // price of a level that does not exist
+};
+
+struct SnapshotLevel {
+    int64_t price;
+    uint32_t size;
+    uint32_t count; // resting orders
+};
+
+struct SnapshotRecordHead {
+    int64_t ts_event; // nanoseconds since the epoch
+    uint32_t instrument_id;
+    int32_t depth; // first visible level the event changed, or -1
+};
+
+// One record of a file written at depth `Depth`.
+template <size_t Depth>
+struct SnapshotRecord {
+    SnapshotRecordHead head;
+    SnapshotLevel bids[Depth];
+    SnapshotLevel asks[Depth];
+};
+
+static_assert(sizeof(SnapshotFileHeader) == 32, "snapshot file header is 32 bytes");
+static_assert(sizeof(SnapshotLevel) == 16, "snapshot level is 16 bytes");
+static_assert(sizeof(SnapshotRecordHead) == 16, "snapshot record head is 16 bytes");
+static_assert(sizeof(SnapshotRecord<10>) == 16 + 20 * 16, "snapshot records have no padding");
+
+constexpr size_t snapshotRecordBytes(size_t depth) {
+    return sizeof(SnapshotRecordHead) + 2 * depth * sizeof(SnapshotLevel);
+}
+
+inline SnapshotFileHeader makeSnapshotFileHeader(size_t depth) {
+    SnapshotFileHeader header;
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+    header.version = kSnapshotVersion;
+    header.depth = static_cast<uint16_t>(depth);
+    header.header_bytes = sizeof(SnapshotFileHeader);
+    header.record_bytes = static_cast<uint32_t>(snapshotRecordBytes(depth));
+    header.price_scale = kPriceScale;
+    header.no_price = kSnapshotNoPrice;
+    return header;
+}
+
+// Longest CSV row writeSnapshotCsv() writes for `depth` levels per side.
+constexpr size_t maxSnapshotCsvBytes(size_t depth) {
+    return kTimestampLength + 1 + kMaxIntegerChars + 2 * depth * (3 + kMaxPriceChars + 2 * kMaxIntegerChars) + 1;
+}
+
+// Writes `level` as its CSV columns (price, size and with `with_counts` the
+// order count), each preceded by a comma; all empty if the level does not exist.
+inline char* writeLevelCsv(char* out, const SnapshotLevel& level, bool with_counts) {
+    if (level.price == kSnapshotNoPrice) {
+        std::memcpy(out, ",,,", 3);
+        return out + (with_counts ? 3 : 2);
+    }
+    *out++ = ',';
+    out = formatPrice2(out, FixedPrice{level.price});
+    *out++ = ',';
+    out = formatUnsigned(out, level.size);
+    if (with_counts) {
+        *out++ = ',';
+        out = formatUnsigned(out, level.count);
+    }
+    return out;
+}
+
+// Writes the record at `record` (`depth` levels per side, prices in 1e-9
+// units) as the CSV row the reconstructor would have written with `format`,
+// less the symbol column. Returns the end of the row.
+inline char* writeSnapshotCsv(char* out, const char* record, size_t depth, const SnapshotFormat& format) {
+    SnapshotRecordHead head;
+    std::memcpy(&head, record, sizeof(head));
+    out += formatTimestamp(head.ts_event, out);
+    if (format.with_depth) {
+        *out++ = ',';
+        if (head.depth >= 0) out = formatInteger(out, head.depth);
+    }
+    const char* levels = record + sizeof(head);
+    for (size_t i = 0; i < 2 * depth; ++i) {
+        SnapshotLevel level;
+        std::memcpy(&level, levels + i * sizeof(level), sizeof(level));
+        out = writeLevelCsv(out, level, format.with_counts);
+    }
+    *out++ = '\n';
+    return out;
+}
+
+// --- Delta snapshots ---
+// With --deltas, output/mbp_deltas.csv holds one line per snapshot row:
+//   ts_event,book,K,symbol,<every level, as in mbp_output.csv>   (keyframe)
+//   +ns,book,D[,<entry>]...                                    (delta)
+// `book` numbers the books in order of first appearance, and a delta's
+// timestamp is the signed offset in nanoseconds from the book's previous
+// line (ts_event is not always monotonic). A delta
+// carries the entries that turn the book's previous levels into the new
+// ones, each for one side (B or A) and level (0 = best):
+//   B,level,price,size[,count]    set a level (empty price: no such level)
+//   IB,level,price,size[,count]   insert a level, shifting the rest down
+//   XB,level                      remove a level, shifting the rest up
+// A new or emptied level thus costs one entry, not one per level it moves.
+// Every book starts with a keyframe and repeats one every
+// keyframe_interval lines, so a reader can start at any keyframe. The
+// header line ends in levels_per_side=N, so the depth is known before the
+// first keyframe (and for a file that has none).
+
+// Largest depth a delta header may give.
+constexpr size_t kMaxDeltaDepth = 1000;
+
+inline std::string deltaCsvHeader(size_t depth, bool with_counts) {
+    return std::string(with_counts ? "ts_event,book,type,side,level,price,size,count"
+                                   : "ts_event,book,type,side,level,price,size") +
+           ",levels_per_side=" + std::to_string(depth) + "\n";
+}
+
+// Longest delta or keyframe line for `depth` levels per side, less the symbol.
+constexpr size_t maxDeltaCsvBytes(size_t depth) {
+    return kTimestampLength + 4 + kMaxIntegerChars + 2 * depth * (6 + kMaxIntegerChars + kMaxPriceChars + 2 * kMaxIntegerChars) + 1;
+}
+
+namespace format_detail {
+
+inline bool sameLevel(const SnapshotLevel& a, const SnapshotLevel& b) {
+    return a.price == b.price && a.size == b.size && a.count == b.count;
+}
+
+inline char* writeDeltaOp(char* out, const char* op, size_t level) {
+    *out++ = ',';
+    while (*op != '\0') *out++ = *op++;
+    *out++ = ',';
+    return formatUnsigned(out, level);
+}
+
+} // namespace format_detail
+
+// Appends the entries that turn `before` into `after`, one side's `depth`
+// levels, of which the first `unchanged` are known to be equal. `side` is 'B' or 'A'.
+inline char* writeDeltaCsv(char* out, char side, const SnapshotLevel* before, const SnapshotLevel* after, size_t depth,
+                           size_t unchanged, bool with_counts) {
+    using namespace format_detail;
+    size_t first = unchanged;
+    while (first < depth && sameLevel(before[first], after[first])) ++first;
+    if (first == depth) return out;
+
+    bool inserted = first + 1 < depth;
+    bool removed = first + 1 < depth;
+    for (size_t i = first; i + 1 < depth && (inserted || removed); ++i) {
+        inserted = inserted && sameLevel(after[i + 1], before[i]);
+        removed = removed && sameLevel(after[i], before[i + 1]);
+    }
+    const char set_op[2] = {side, '\0'};
+    if (inserted && after[first].price != kSnapshotNoPrice) {
+        const char insert_op[3] = {'I', side, '\0'};
+        return writeLevelCsv(writeDeltaOp(out, insert_op, first), after[first], with_counts);
+    }
+    if (removed) {
+        const char remove_op[3] = {'X', side, '\0'};
+        out = writeDeltaOp(out, remove_op, first);
+        // The level that moved up into the last slot.
+        if (after[depth - 1].price == kSnapshotNoPrice) return out;
+        return writeLevelCsv(writeDeltaOp(out, set_op, depth - 1), after[depth - 1], with_counts);
+    }
+    for (size_t i = first; i < depth; ++i) {
+        if (!sameLevel(before[i], after[i])) out = writeLevelCsv(writeDeltaOp(out, set_op, i), after[i], with_counts);
+    }
+    return out;
+}
+
+// Rebuilds each book's levels from a delta file, one line at a time. Lines
+// are passed as records with fieldCount() and field(i), e.g. CsvRecord.
+class DeltaCsvReader {
+public:
+    struct Book {
+        std::vector<SnapshotLevel> bids;
+        std::vector<SnapshotLevel> asks;
+        std::string symbol;
+        int64_t ts_event = 0;
+        bool started = false; // has had its first keyframe
+    };
+
+    // Checks the file's header line (without its newline) and takes the
+    // levels per side and whether levels carry order counts from it.
+    bool readHeader(std::string_view line) {
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        const size_t last_comma = line.rfind(',');
+        if (last_comma == std::string_view::npos) return fail("not a delta file header");
+        const std::string_view depth = line.substr(last_comma + 1);
+        constexpr std::string_view kDepthKey = "levels_per_side=";
+        if (depth.substr(0, kDepthKey.size()) != kDepthKey || !isNumber(depth.substr(kDepthKey.size())) ||
+            depth.size() > kDepthKey.size() + 4) {
+            return fail("delta file header has no levels_per_side");
+        }
+        depth_ = static_cast<size_t>(parseInteger(depth.substr(kDepthKey.size())));
+        if (depth_ == 0 || depth_ > kMaxDeltaDepth) return fail("unsupported levels_per_side");
+        for (bool with_counts : {false, true}) {
+            std::string header = deltaCsvHeader(depth_, with_counts);
+            header.pop_back();
+            if (line == header) {
+                with_counts_ = with_counts;
+                return true;
+            }
+        }
+        return fail("not a delta file header");
+    }
+
+    // Applies one line. On success book() is the book it updated and
+    // changedDepth() the first level that differs from the book's previous
+    // line on either side (-1 if none).
+    template <typename Record>
+    bool apply(const Record& line) {
+        const size_t fields = line.fieldCount();
+        const size_t per_level = with_counts_ ? 3 : 2;
+        if (fields < 3 || !isNumber(line.field(1))) return fail("malformed line");
+        const size_t index = static_cast<size_t>(parseInteger(line.field(1)));
+        if (index > books_.size()) return fail("book numbers must appear in order");
+        if (index == books_.size()) books_.emplace_back();
+        Book& book = books_[index];
+        const std::string_view type = line.field(2);
+
+        if (type == "K") {
+            if (fields < 4 || (fields - 4) % (2 * per_level) != 0) return fail("malformed keyframe");
+            if ((fields - 4) / (2 * per_level) != depth_) return fail("keyframe depth differs from the header's");
+            if (!parseTimestamp(line.field(0), book.ts_event)) return fail("malformed timestamp");
+            if (!book.started) {
+                book.bids.assign(depth_, kEmptyLevel);
+                book.asks.assign(depth_, kEmptyLevel);
+                book.started = true;
+            }
+            remember(book);
+            book.symbol.assign(line.field(3));
+            for (size_t i = 0; i < 2 * depth_; ++i) {
+                SnapshotLevel& level = i < depth_ ? book.bids[i] : book.asks[i - depth_];
+                if (!parseLevel(line, 4 + i * per_level, level)) return fail("malformed level");
+            }
+        } else if (type == "D") {
+            if (!book.started) return fail("delta before the book's first keyframe");
+            const std::string_view gap = line.field(0);
+            if (gap.size() < 2 || (gap[0] != '+' && gap[0] != '-') || !isNumber(gap.substr(1))) {
+                return fail("malformed time offset");
+            }
+            book.ts_event += parseInteger(gap);
+            remember(book);
+            for (size_t f = 3; f < fields;) {
+                const std::string_view op = line.field(f);
+                if (op.empty() || f + 1 >= fields || !isNumber(line.field(f + 1))) return fail("malformed entry");
+                std::vector<SnapshotLevel>& side = op.back() == 'B' ? book.bids : book.asks;
+                const size_t level = static_cast<size_t>(parseInteger(line.field(f + 1)));
+                if ((op.back() != 'B' && op.back() != 'A') || level >= depth_) return fail("malformed entry");
+                if (op.size() == 2 && op[0] == 'X') {
+                    side.erase(side.begin() + level);
+                    side.push_back(kEmptyLevel);
+                    f += 2;
+                    continue;
+                }
+                if (op.size() == 2 && op[0] == 'I') {
+                    side.pop_back();
+                    side.insert(side.begin() + level, kEmptyLevel);
+                } else if (op.size() != 1) {
+                    return fail("malformed entry");
+                }
+                if (f + 2 + per_level > fields || !parseLevel(line, f + 2, side[level])) return fail("malformed level");
+                f += 2 + per_level;
+            }
+        } else {
+            return fail("unknown line type");
+        }
+
+        current_ = &book;
+        changed_depth_ = -1;
+        for (size_t i = 0; i < depth_ && changed_depth_ < 0; ++i) {
+            if (!format_detail::sameLevel(book.bids[i], before_bids_[i]) ||
+                !format_detail::sameLevel(book.asks[i], before_asks_[i])) {
+                changed_depth_ = static_cast<int>(i);
+            }
+        }
+        return true;
+    }
+
+    const Book& book() const { return *current_; }
+    int changedDepth() const { return changed_depth_; }
+    size_t depth() const { return depth_; } // levels per side, from the header
+    bool withCounts() const { return with_counts_; }
+    const std::string& error() const { return error_; }
+
+private:
+    static constexpr SnapshotLevel kEmptyLevel = {kSnapshotNoPrice, 0, 0};
+
+    bool with_counts_ = false;
+    size_t depth_ = 0;
+    std::vector<Book> books_;
+    std::vector<SnapshotLevel> before_bids_;
+    std::vector<SnapshotLevel> before_asks_;
+    const Book* current_ = nullptr;
+    int changed_depth_ = -1;
+    std::string error_;
+
+    bool fail(const char* message) {
+        error_ = message;
+        return false;
+    }
+
+    static bool isNumber(std::string_view text) {
+        return !text.empty() && text.find_first_not_of("0123456789") == std::string_view::npos;
+    }
+
+    void remember(const Book& book) {
+        before_bids_.assign(book.bids.begin(), book.bids.end());
+        before_asks_.assign(book.asks.begin(), book.asks.end());
+    }
+
+    // Reads the price, size (and count) fields starting at `first`.
+    template <typename Record>
+    bool parseLevel(const Record& line, size_t first, SnapshotLevel& level) const {
+        const std::string_view price = line.field(first);
+        const std::string_view size = line.field(first + 1);
+        const std::string_view count = with_counts_ ? line.field(first + 2) : std::string_view();
+        if (price.empty()) {
+            level = kEmptyLevel;
+            return size.empty() && count.empty();
+        }
+        FixedPrice units;
+        if (!parseFixedPrice(price, units) || !isNumber(size) || (with_counts_ && !isNumber(count))) return false;
+        level = SnapshotLevel{units.units, static_cast<uint32_t>(parseInteger(size)),
+                              with_counts_ ? static_cast<uint32_t>(parseInteger(count)) : 0u};
+        return true;
+    }
+};
+
+// --- Vendor MBP-10 rows ---
+// With --mbp10, output/mbp_output.csv has the layout of the vendor's MBP-10
+// CSV (data/mbp.csv): a row number, the event's own columns (ts_recv,
+// ts_event, rtype, publisher_id, instrument_id, action, side, depth, price,
+// size, flags, ts_in_delta, sequence), the ten levels of each side
+// interleaved as bid_px_00, bid_sz_00, bid_ct_00, ask_px_00, ..., then
+// symbol and order_id. `depth` is the book level the event touched. Prices
+// are written exactly with formatPriceShort(); a missing level has an empty
+// price and zero size and count. As in data/mbp.csv, ts_recv repeats the
+// event time and lines end in CRLF.
+
+constexpr size_t kMbp10Depth = 10;
+// Adds, cancels and fills get a row down to this book level (0 = best): the
+// ten visible levels and the first one below them.
+constexpr int kMbp10LastLevel = 10;
+constexpr int kMbp10RType = 10;
+
+inline std::string mbp10CsvHeader() {
+    std::string header = ",ts_recv,ts_event,rtype,publisher_id,instrument_id,action,side,depth,price,size,flags,"
+                         "ts_in_delta,sequence";
+    for (size_t i = 0; i < kMbp10Depth; ++i) {
+        const std::string level = (i < 10 ? "_0" : "_") + std::to_string(i);
+        for (const char* side : {"bid", "ask"}) {
+            header += std::string(",") + side + "_px" + level + "," + side + "_sz" + level + "," + side + "_ct" + level;
+        }
+    }
+    return header + ",symbol,order_id\r\n";
+}
+
+// Longest row writeMbp10Csv() writes, less the symbol. The separators, the
+// two one-letter columns and the line end fit in the last term.
+constexpr size_t maxMbp10CsvBytes() {
+    return 2 * kTimestampLength + 10 * kMaxIntegerChars + kMaxPriceChars +
+           2 * kMbp10Depth * (3 + kMaxPriceChars + 2 * kMaxIntegerChars) + 20;
+}
+
+namespace format_detail {
+
+inline char* writeMbp10Level(char* out, const SnapshotLevel& level) {
+    if (level.price == kSnapshotNoPrice) {
+        std::memcpy(out, ",,0,0", 5);
+        return out + 5;
+    }
+    *out++ = ',';
+    out = formatPriceShort(out, FixedPrice{level.price});
+    *out++ = ',';
+    out = formatUnsigned(out, level.size);
+    *out++ = ',';
+    return formatUnsigned(out, level.count);
+}
+
+} // namespace format_detail
+
+// Writes row number `index` for `event`, which touched book level `depth`,
+// followed by the first kMbp10Depth levels of `bids` and `asks`, best first.
+// A reset has no price. Returns the end of the row.
+inline char* writeMbp10Csv(char* out, uint64_t index, const MboEvent& event, int depth, const SnapshotLevel* bids,
+                           const SnapshotLevel* asks, std::string_view symbol) {
+    out = formatUnsigned(out, index);
+    for (int i = 0; i < 2; ++i) {
+        *out++ = ',';
+        out += formatTimestamp(event.ts_event, out);
+    }
+    *out++ = ',';
+    out = formatUnsigned(out, kMbp10RType);
+    *out++ = ',';
+    out = formatUnsigned(out, event.publisher_id);
+    *out++ = ',';
+    out = formatUnsigned(out, event.instrument_id);
+    *out++ = ',';
+    *out++ = event.action;
+    *out++ = ',';
+    *out++ = event.side;
+    *out++ = ',';
+    out = formatInteger(out, depth);
+    *out++ = ',';
+    if (event.action != 'R') out = formatPriceShort(out, event.price);
+    *out++ = ',';
+    out = formatInteger(out, event.size);
+    *out++ = ',';
+    out = formatUnsigned(out, event.flags);
+    *out++ = ',';
+    out = formatInteger(out, event.ts_in_delta);
+    *out++ = ',';
+    out = formatUnsigned(out, event.sequence);
+    for (size_t i = 0; i < kMbp10Depth; ++i) {
+        out = format_detail::writeMbp10Level(out, bids[i]);
+        out = format_detail::writeMbp10Level(out, asks[i]);
+    }
+    *out++ = ',';
+    std::memcpy(out, symbol.data(), symbol.size());
+    out += symbol.size();
+    *out++ = ',';
+    out = formatInteger(out, event.order_id);
+    std::memcpy(out, "\r\n", 2);
+    return out + 2;
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "field_parsers.h"
+
+// --- Snapshot Formatters ---
+// Allocation-free, locale-independent writers for the numeric columns of a
+// snapshot row. Each writes at the given pointer and returns one past the
+// last byte written; the caller guarantees the space (see the kMax constants).
+
+// Longest text formatInteger can write ("-9223372036854775808").
+constexpr size_t kMaxIntegerChars = 20;
+// Longest text a price formatter writes.
+constexpr size_t kMaxPriceChars = 32;
+
+namespace format_detail {
+
+// "00" "01" ... "99": two digits per table lookup.
+struct DigitPairs {
+    char text[200];
+    constexpr DigitPairs() : text() {
+        for (int i = 0; i < 100; ++i) {
+            text[2 * i] = static_cast<char>('0' + i / 10);
+            text[2 * i + 1] = static_cast<char>('0' + i % 10);
+        }
+    }
+};
+constexpr DigitPairs kDigitPairs;
+
+inline char* writeTwoDigits(char* out, uint64_t value) {
+    std::memcpy(out, kDigitPairs.text + 2 * value, 2);
+    return out + 2;
+}
+
+inline int countDigits(uint64_t value) {
+    int digits = 1;
+    for (; value >= 10000; value /= 10000) digits += 4;
+    if (value >= 1000) return digits + 3;
+    if (value >= 100) return digits + 2;
+    if (value >= 10) return digits + 1;
+    return digits;
+}
+
+// Above this a FixedPrice is not exact in a double; such prices go through snprintf.
+constexpr uint64_t kMaxExactUnits = uint64_t(1) << 53;
+
+} // namespace format_detail
+
+inline char* formatUnsigned(char* out, uint64_t value) {
+    using namespace format_detail;
+    char* end = out + countDigits(value);
+    char* p = end;
+    while (value >= 100) {
+        p -= 2;
+        writeTwoDigits(p, value % 100);
+        value /= 100;
+    }
+    if (value >= 10) {
+        writeTwoDigits(p - 2, value);
+    } else {
+        p[-1] = static_cast<char>('0' + value);
+    }
+    return end;
+}
+
+inline char* formatInteger(char* out, int64_t value) {
+    if (value < 0) {
+        *out++ = '-';
+        return formatUnsigned(out, 0 - static_cast<uint64_t>(value));
+    }
+    return formatUnsigned(out, static_cast<uint64_t>(value));
+}
+
+// Writes `value` as "%.2f" would (snprintf into at most kMaxPriceChars bytes).
+inline char* formatDecimal2(char* out, double value) {
+    char text[kMaxPriceChars + 1];
+    int length = std::snprintf(text, sizeof(text), "%.2f", value);
+    if (length < 0) length = 0;
+    if (length > static_cast<int>(kMaxPriceChars)) length = kMaxPriceChars;
+    std::memcpy(out, text, length);
+    return out + length;
+}
+
+// Writes `price` with two decimals, byte for byte what "%.2f" prints for
+// price.toDouble(), using integer arithmetic only. "%.2f" rounds the exact
+// value of the double half to even. Away from a decimal tie (a remainder of
+// exactly 0.005) the double sits on the same side of the tie as the decimal
+// price, since it is within half an ulp (< 1e-9) of it. On a decimal tie the
+// sign of toDouble() * 1e9 - units, computed exactly by fma, tells whether
+// the double rounded above, below or onto the tie.
+inline char* formatPrice2(char* out, FixedPrice price) {
+    using namespace format_detail;
+    const bool negative = price.units < 0;
+    const uint64_t units = negative ? 0 - static_cast<uint64_t>(price.units) : static_cast<uint64_t>(price.units);
+    if (units > kMaxExactUnits) return formatDecimal2(out, price.toDouble());
+
+    constexpr uint64_t kUnitsPerCent = kPriceScale / 100;
+    uint64_t cents = units / kUnitsPerCent;
+    const uint64_t rest = units % kUnitsPerCent;
+    if (rest > kUnitsPerCent / 2) {
+        ++cents;
+    } else if (rest == kUnitsPerCent / 2) {
+        const double magnitude = static_cast<double>(units) / static_cast<double>(kPriceScale);
+        const double error = std::fma(magnitude, static_cast<double>(kPriceScale), -static_cast<double>(units));
+        if (error > 0 || (error == 0 && (cents & 1) != 0)) ++cents;
+    }
+
+    // "%.2f" keeps the sign of a negative price that rounds to zero ("-0.00").
+    if (negative) *out++ = '-';
+    out = formatUnsigned(out, cents / 100);
+    *out++ = '.';
+    return writeTwoDigits(out, cents % 100);
+}
+
+// Writes `price` exactly, with as many decimals as it needs but at least one
+// ("13.4", "13.0", "13.575"), the way the vendor's MBP-10 CSV prints prices.
+inline char* formatPriceShort(char* out, FixedPrice price) {
+    const bool negative = price.units < 0;
+    const uint64_t units = negative ? 0 - static_cast<uint64_t>(price.units) : static_cast<uint64_t>(price.units);
+    if (negative) *out++ = '-';
+    out = formatUnsigned(out, units / kPriceScale);
+    *out++ = '.';
+    uint64_t fraction = units % kPriceScale;
+    if (fraction == 0) {
+        *out++ = '0';
+        return out;
+    }
+    int digits = kPriceDecimals;
+    while (fraction % 10 == 0) {
+        fraction /= 10;
+        --digits;
+    }
+    // Leading zeros of the fraction, then its significant digits.
+    const int length = format_detail::countDigits(fraction);
+    std::memset(out, '0', digits - length);
+    return formatUnsigned(out + (digits - length), fraction);
+}
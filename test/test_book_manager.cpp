@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include <string>
+
+#include "../src/book_manager.h"
+#include "../src/order_book.h"
+
+namespace {
+
+MboEvent addEvent(uint16_t publisher, uint32_t instrument, std::string_view symbol, long long id, const char* price) {
+    MboEvent event;
+    event.action = 'A';
+    event.side = 'B';
+    event.order_id = id;
+    event.price = parseFixedPrice(price);
+    event.size = 10;
+    event.publisher_id = publisher;
+    event.instrument_id = instrument;
+    event.symbol = symbol;
+    return event;
+}
+
+} // namespace
+
+TEST(BookManagerTest, KeepsOneBookPerInstrument) {
+    BookManager<OrderBook> books;
+    MboEvent events[] = {
+        addEvent(2, 1108, "ARL", 1, "5.51"),
+        addEvent(2, 1108, "", 2, "5.52"),   // symbol missing on this line
+        addEvent(2, 2000, "XYZ", 3, "100.00"),
+        addEvent(3, 1108, "ARL.B", 4, "7.00"), // same instrument id, other publisher
+    };
+    for (const MboEvent& event : events) books.bookFor(event).book.apply(event);
+    ASSERT_EQ(books.size(), 3u);
+
+    auto& first = books.bookFor(events[0]);
+    char levels[OrderBook::kMaxLevelsBytes];
+    ASSERT_EQ(first.symbol, "ARL");
+    ASSERT_EQ(std::string(levels, first.book.writeLevels(levels) - levels), ",5.52,10,5.51,10,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,");
+
+    auto& other = books.bookFor(events[3]);
+    ASSERT_EQ(other.symbol, "ARL.B");
+    ASSERT_EQ(other.publisher_id, 3);
+    ASSERT_EQ(books[1].symbol, "XYZ");
+}
+
+TEST(BookManagerTest, ResetOnlyClearsItsOwnBook) {
+    BookManager<OrderBook> books;
+    MboEvent a = addEvent(1, 1, "A", 1, "1.00");
+    MboEvent b = addEvent(1, 2, "B", 2, "2.00");
+    books.bookFor(a).book.apply(a);
+    books.bookFor(b).book.apply(b);
+
+    MboEvent reset = a;
+    reset.action = 'R';
+    ASSERT_EQ(books.bookFor(reset).book.apply(reset), 0);
+    ASSERT_EQ(books.bookFor(a).book.topBids().depth(), 0u);
+    ASSERT_EQ(books.bookFor(b).book.topBids().depth(), 1u);
+}
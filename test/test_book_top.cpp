@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "../src/book_top.h"
+#include "../src/price_levels.h"
+
+using Level = std::tuple<int64_t, int, int>;
+
+template <typename Top>
+std::vector<Level> cached(const Top& top) {
+    std::vector<Level> out;
+    for (size_t i = 0; i < top.depth(); ++i) out.emplace_back(top.price(i), top.total(i).size, top.total(i).count);
+    return out;
+}
+
+template <typename Levels>
+std::vector<Level> walked(const Levels& levels, size_t n) {
+    std::vector<Level> out;
+    levels.forEachBest(n, [&out](int64_t price, int size, int count) { out.emplace_back(price, size, count); });
+    return out;
+}
+
+TEST(TopLevelsTest, ShiftsInsertsAndRefillsOnRemoval) {
+    MapLevels<int64_t, std::less<int64_t>> asks;
+    TopLevels<int64_t, std::less<int64_t>, 3> top;
+    auto add = [&](int64_t price, int size, int count) {
+        asks.add(price, size, count);
+        top.update(asks, price, size, count);
+    };
+    add(103, 1, 1);
+    add(101, 1, 1);
+    add(104, 1, 1);
+    add(102, 1, 1); // shifts 104 out of the visible three
+    ASSERT_EQ(cached(top), (std::vector<Level>{{101, 1, 1}, {102, 1, 1}, {103, 1, 1}}));
+    add(104, 5, 1); // beyond the visible depth
+    add(101, -1, -1); // emptying a visible level pulls 104 back up
+    ASSERT_EQ(cached(top), (std::vector<Level>{{102, 1, 1}, {103, 1, 1}, {104, 6, 2}}));
+}
+
+TEST(TopLevelsTest, MatchesContainerUnderRandomUpdates) {
+    MapLevels<int64_t, std::greater<int64_t>> bids;
+    TopLevels<int64_t, std::greater<int64_t>, 10> top;
+    std::mt19937 rng(11);
+    for (int step = 0; step < 20000; ++step) {
+        int64_t price = 1000 + static_cast<int64_t>(rng() % 40);
+        int size = static_cast<int>(rng() % 10) + 1;
+        if (rng() % 2) size = -size;
+        int count = size > 0 ? 1 : -1;
+        bids.add(price, size, count);
+        top.update(bids, price, size, count);
+        ASSERT_EQ(cached(top), walked(bids, 10)) << "step " << step;
+    }
+}
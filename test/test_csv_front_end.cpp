@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../src/csv_front_end.h"
+
+namespace {
+
+// Keeps a copy of every event it is handed, in order.
+class RecordingSink : public EventSink {
+public:
+    std::vector<MboEvent> events;
+    std::vector<std::string> symbols; // events[i].symbol points into the input
+
+    void onEvents(const MboEvent* batch, size_t count) override {
+        for (size_t i = 0; i < count; ++i) {
+            events.push_back(batch[i]);
+            symbols.emplace_back(batch[i].symbol);
+        }
+    }
+    void reserveFor(size_t) override {}
+    void finish() override {}
+    double firstEventMs() const override { return -1; }
+};
+
+// An MBO export with `rows` data lines ending in `eol`. Every 50th line carries
+// a long symbol so some lines are longer than the small test chunks.
+std::string mboCsv(int rows, const char* eol) {
+    std::string text = std::string("ts_recv,ts_event,rtype,publisher_id,instrument_id,action,side,price,size,"
+                                   "channel_id,order_id,flags,ts_in_delta,sequence,symbol") + eol;
+    for (int i = 0; i < rows; ++i) {
+        text += "2025-07-17T08:05:03.360842448Z,2025-07-17T08:05:03.3606772" + std::to_string(10 + i % 90) +
+                "Z,160,2,1108," + "ACTF"[i % 4] + "," + "BA"[i % 2] + ",5." + std::to_string(100 + i % 900) +
+                "000000," + std::to_string(1 + i % 500) + ",0," + std::to_string(800000 + i) + ",130,165200," +
+                std::to_string(851012 + i) + "," + (i % 50 == 0 ? std::string(120, 'S') : "ARL") + eol;
+    }
+    return text;
+}
+
+RecordingSink decode(const std::string& csv, size_t threads, size_t parse_chunk_bytes) {
+    RecordingSink sink;
+    CsvFrontEnd front_end(ScanKernel::Auto, threads, sink, parse_chunk_bytes);
+    EXPECT_TRUE(front_end.consume(csv));
+    return sink;
+}
+
+void expectSameEvents(const RecordingSink& expected, const RecordingSink& actual) {
+    ASSERT_EQ(actual.events.size(), expected.events.size());
+    for (size_t i = 0; i < expected.events.size(); ++i) {
+        const MboEvent& a = expected.events[i];
+        const MboEvent& b = actual.events[i];
+        ASSERT_EQ(b.ts_event, a.ts_event) << i;
+        ASSERT_EQ(b.price, a.price) << i;
+        ASSERT_EQ(b.order_id, a.order_id) << i;
+        ASSERT_EQ(b.size, a.size) << i;
+        ASSERT_EQ(b.action, a.action) << i;
+        ASSERT_EQ(b.side, a.side) << i;
+        ASSERT_EQ(b.flags, a.flags) << i;
+        ASSERT_EQ(b.publisher_id, a.publisher_id) << i;
+        ASSERT_EQ(b.instrument_id, a.instrument_id) << i;
+        ASSERT_EQ(b.ts_in_delta, a.ts_in_delta) << i;
+        ASSERT_EQ(b.sequence, a.sequence) << i;
+        ASSERT_EQ(actual.symbols[i], expected.symbols[i]) << i;
+    }
+}
+
+} // namespace
+
+TEST(CsvFrontEndTest, ParallelParseMatchesSingleThreadAcrossWindows) {
+    for (const char* eol : {"\n", "\r\n"}) {
+        const std::string csv = mboCsv(1000, eol);
+        const RecordingSink expected = decode(csv, 1, kParseChunkBytes);
+        ASSERT_EQ(expected.events.size(), 1000u);
+        ASSERT_EQ(expected.symbols[1], "ARL"); // no '\r' left on the last column
+
+        // Small chunks make many windows whose boundaries fall mid-line, plus
+        // lines longer than a whole chunk.
+        for (size_t threads : {2, 3, 8}) {
+            for (size_t chunk_bytes : {1, 37, 100, 4096}) {
+                SCOPED_TRACE(testing::Message() << "threads=" << threads << " chunk=" << chunk_bytes
+                                                << (eol[0] == '\r' ? " crlf" : " lf"));
+                expectSameEvents(expected, decode(csv, threads, chunk_bytes));
+            }
+        }
+    }
+}
+
+TEST(CsvFrontEndTest, WorkersCarryOverAcrossConsumeCalls) {
+    const std::string csv = mboCsv(300, "\r\n");
+    const RecordingSink expected = decode(csv, 1, kParseChunkBytes);
+
+    // Feed the same text a run of whole lines at a time, as LineAssembler does.
+    RecordingSink sink;
+    CsvFrontEnd front_end(ScanKernel::Auto, 4, sink, 64);
+    std::string_view rest = csv;
+    while (!rest.empty()) {
+        size_t run = lineBlockLength(rest, 500);
+        ASSERT_TRUE(front_end.consume(rest.substr(0, run)));
+        rest.remove_prefix(run);
+    }
+    expectSameEvents(expected, sink);
+}
+
+TEST(CsvFrontEndTest, RejectsHeaderWithoutRequiredColumn) {
+    RecordingSink sink;
+    CsvFrontEnd front_end(ScanKernel::Auto, 2, sink);
+    ASSERT_FALSE(front_end.consume("ts_event,action,side,price,size\n"));
+    ASSERT_TRUE(sink.events.empty());
+}
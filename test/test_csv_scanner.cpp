@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/csv_scanner.h"
+
+namespace {
+
+// Collects every line of `text` as a list of fields using the given kernel.
+std::vector<std::vector<std::string>> scanAll(const std::string& text, ScanKernel kernel) {
+    StructuralScanner scanner(kernel);
+    scanner.scan(text);
+    std::vector<std::vector<std::string>> lines;
+    CsvRecord record;
+    while (scanner.next(record)) {
+        std::vector<std::string> fields;
+        for (size_t i = 0; i < record.fieldCount(); ++i) fields.emplace_back(record.field(i));
+        lines.push_back(fields);
+    }
+    return lines;
+}
+
+} // namespace
+
+TEST(CsvScannerTest, SplitsLinesAndFields) {
+    auto lines = scanAll("a,bb,,c\nx,y\n", ScanKernel::Auto);
+    ASSERT_EQ(lines.size(), 2u);
+    ASSERT_EQ(lines[0], (std::vector<std::string>{"a", "bb", "", "c"}));
+    ASSERT_EQ(lines[1], (std::vector<std::string>{"x", "y"}));
+}
+
+TEST(CsvScannerTest, HandlesMissingFinalNewline) {
+    auto lines = scanAll("1,2\n3,4", ScanKernel::Auto);
+    ASSERT_EQ(lines.size(), 2u);
+    ASSERT_EQ(lines[1], (std::vector<std::string>{"3", "4"}));
+}
+
+TEST(CsvScannerTest, KernelsAgreeOnRandomInput) {
+    std::mt19937 rng(42);
+    const char alphabet[] = "0123456789.,,\nABZ";
+    std::string text;
+    for (int i = 0; i < 4099; ++i) text += alphabet[rng() % (sizeof(alphabet) - 1)];
+
+    auto expected = scanAll(text, ScanKernel::Scalar);
+    ASSERT_EQ(scanAll(text, ScanKernel::Sse2), expected);
+    ASSERT_EQ(scanAll(text, ScanKernel::Avx2), expected);
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../src/dbn.h"
+
+namespace {
+
+DbnMboRecord makeRecord(char action, char side, int64_t price, uint32_t size, uint64_t order_id) {
+    DbnMboRecord record{};
+    record.hd.length = sizeof(DbnMboRecord) / 4;
+    record.hd.rtype = kDbnRTypeMbo;
+    record.hd.instrument_id = 1108;
+    record.hd.ts_event = 1752739503360677248ULL; // 2025-07-17T08:05:03.360677248Z
+    record.action = action;
+    record.side = side;
+    record.price = price;
+    record.size = size;
+    record.order_id = order_id;
+    return record;
+}
+
+std::string encode(const std::vector<DbnMboRecord>& records) {
+    std::string data = encodeDbnMetadata(0, 1, 20250717, 20250718, {{"ARL", 1108}});
+    for (const auto& record : records) data.append(reinterpret_cast<const char*>(&record), sizeof(record));
+    return data;
+}
+
+} // namespace
+
+TEST(DbnTest, DecodesMboRecordsAcrossChunkBoundaries) {
+    std::string data = encode({makeRecord('A', 'B', 5510000000LL, 100, 817593),
+                               makeRecord('R', 'N', kDbnUndefPrice, 0, 0)});
+    ASSERT_TRUE(isDbn(data));
+
+    // Feed one byte at a time so the metadata and every record are split.
+    DbnDecoder decoder;
+    std::vector<MboEvent> events;
+    for (char byte : data) {
+        ASSERT_TRUE(decoder.feed(std::string_view(&byte, 1), [&](const MboEvent& event) { events.push_back(event); }));
+    }
+    ASSERT_TRUE(decoder.finish());
+
+    ASSERT_EQ(events.size(), 2u);
+    ASSERT_EQ(events[0].ts_event, 1752739503360677248LL);
+    ASSERT_EQ(events[0].action, 'A');
+    ASSERT_EQ(events[0].side, 'B');
+    ASSERT_EQ(events[0].price.units, 5510000000LL);
+    ASSERT_EQ(events[0].size, 100);
+    ASSERT_EQ(events[0].order_id, 817593);
+    ASSERT_EQ(events[1].action, 'R');
+    ASSERT_EQ(events[1].price.units, 0);
+}
+
+TEST(DbnTest, ReportsTruncatedRecord) {
+    std::string data = encode({makeRecord('C', 'A', 0, 0, 1)});
+    data.pop_back();
+    DbnDecoder decoder;
+    ASSERT_TRUE(decoder.feed(data, [](const MboEvent&) {}));
+    ASSERT_FALSE(decoder.finish());
+}
+
+TEST(DbnTest, NamesInstrumentsFromSymbology) {
+    std::string data = encodeDbnMetadata(0, 1, 20250717, 20250718, {{"ARL", 1108}, {"XYZ", 2000}});
+    DbnMboRecord arl = makeRecord('A', 'B', 5510000000LL, 100, 1);
+    DbnMboRecord xyz = arl;
+    xyz.hd.instrument_id = 2000;
+    xyz.hd.publisher_id = 3;
+    DbnMboRecord unknown = arl;
+    unknown.hd.instrument_id = 7;
+    for (const auto& record : {arl, xyz, unknown}) data.append(reinterpret_cast<const char*>(&record), sizeof(record));
+
+    DbnDecoder decoder;
+    std::vector<std::pair<std::string, uint16_t>> seen;
+    ASSERT_TRUE(decoder.feed(data, [&](const MboEvent& event) { seen.emplace_back(event.symbol, event.publisher_id); }));
+    std::vector<std::pair<std::string, uint16_t>> expected = {{"ARL", 0}, {"XYZ", 3}, {"", 0}};
+    ASSERT_EQ(seen, expected);
+}
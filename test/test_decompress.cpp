@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+#include "../src/decompress.h"
+
+namespace {
+
+// A temporary file holding `data`, open for reading and removed on destruction.
+class TempInput {
+public:
+    explicit TempInput(const std::string& data) {
+        fd_ = ::mkstemp(path_);
+        if (fd_ < 0) return;
+        if (::write(fd_, data.data(), data.size()) != static_cast<ssize_t>(data.size())) return;
+        ::lseek(fd_, 0, SEEK_SET);
+    }
+    ~TempInput() {
+        ::close(fd_);
+        ::unlink(path_);
+    }
+    int fd() const { return fd_; }
+
+private:
+    char path_[32] = "/tmp/decompress_testXXXXXX";
+    int fd_ = -1;
+};
+
+// Reads `stream` to the end in small pieces. Returns false on a read error.
+bool readAll(DecodingStream& stream, std::string& text) {
+    char buffer[100];
+    for (long n; (n = stream.read(buffer, sizeof(buffer))) != 0;) {
+        if (n < 0) return false;
+        text.append(buffer, n);
+    }
+    return true;
+}
+
+std::string sampleText() {
+    std::string text;
+    for (int i = 0; i < 2000; ++i) text += "2025-07-17T08:05:03.360677248Z,A,B,5.51," + std::to_string(i) + "\n";
+    return text;
+}
+
+#ifdef RECON_HAVE_ZLIB
+std::string gzip(const std::string& text) {
+    z_stream z{};
+    deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+    std::string out(deflateBound(&z, text.size()) + 32, '\0');
+    z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+    z.avail_in = static_cast<uInt>(text.size());
+    z.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    z.avail_out = static_cast<uInt>(out.size());
+    deflate(&z, Z_FINISH);
+    out.resize(z.total_out);
+    deflateEnd(&z);
+    return out;
+}
+#endif
+
+} // namespace
+
+TEST(DecodingStreamTest, PassesUncompressedInputThrough) {
+    const std::string text = sampleText();
+    TempInput input(text);
+    DecodingStream stream(input.fd(), 64);
+    std::string read;
+    ASSERT_TRUE(readAll(stream, read));
+    ASSERT_EQ(stream.compression(), Compression::None);
+    ASSERT_EQ(read, text);
+}
+
+TEST(DecodingStreamTest, PassesShortInputThrough) {
+    TempInput input("A\n");
+    DecodingStream stream(input.fd());
+    std::string read;
+    ASSERT_TRUE(readAll(stream, read));
+    ASSERT_EQ(read, "A\n");
+}
+
+TEST(DecodingStreamTest, ReportsReadError) {
+    DecodingStream stream(-1);
+    char buffer[16];
+    ASSERT_EQ(stream.read(buffer, sizeof(buffer)), -1);
+    ASSERT_EQ(stream.error(), "read error");
+}
+
+#ifdef RECON_HAVE_ZLIB
+TEST(DecodingStreamTest, RoundTripsGzipIncludingConcatenatedMembers) {
+    const std::string text = sampleText();
+    TempInput input(gzip(text) + gzip(text));
+    DecodingStream stream(input.fd(), 256); // small input buffer: many refills
+    std::string read;
+    ASSERT_TRUE(readAll(stream, read)) << stream.error();
+    ASSERT_EQ(stream.compression(), Compression::Gzip);
+    ASSERT_EQ(read, text + text);
+}
+
+TEST(DecodingStreamTest, SniffsGzipFromASourceThatHandsOutSingleBytes) {
+    // Like a pipe that delivers the magic in pieces: nothing is read twice.
+    const std::string text = sampleText();
+    const std::string compressed = gzip(text);
+    size_t pos = 0;
+    DecodingStream stream([&](char* buffer, size_t capacity) -> long {
+        if (pos == compressed.size() || capacity == 0) return 0;
+        buffer[0] = compressed[pos++];
+        return 1;
+    });
+    std::string read;
+    ASSERT_TRUE(readAll(stream, read)) << stream.error();
+    ASSERT_EQ(stream.compression(), Compression::Gzip);
+    ASSERT_EQ(read, text);
+}
+
+TEST(DecodingStreamTest, ReportsTruncatedGzip) {
+    const std::string compressed = gzip(sampleText());
+    TempInput input(compressed.substr(0, compressed.size() / 2));
+    DecodingStream stream(input.fd());
+    std::string read;
+    ASSERT_FALSE(readAll(stream, read));
+    ASSERT_EQ(stream.error(), "truncated gzip stream");
+}
+
+TEST(DecodingStreamTest, ReportsCorruptGzip) {
+    std::string compressed = gzip(sampleText());
+    for (size_t i = 10; i < 40; ++i) compressed[i] = static_cast<char>(0xFF);
+    TempInput input(compressed);
+    DecodingStream stream(input.fd());
+    std::string read;
+    ASSERT_FALSE(readAll(stream, read));
+    ASSERT_EQ(stream.error(), "corrupt gzip stream");
+}
+#endif
+
+#ifdef RECON_HAVE_ZSTD
+TEST(DecodingStreamTest, RoundTripsZstdAndReportsTruncation) {
+    const std::string text = sampleText();
+    std::string compressed(ZSTD_compressBound(text.size()), '\0');
+    compressed.resize(ZSTD_compress(&compressed[0], compressed.size(), text.data(), text.size(), 3));
+
+    TempInput input(compressed);
+    DecodingStream stream(input.fd(), 256);
+    std::string read;
+    ASSERT_TRUE(readAll(stream, read)) << stream.error();
+    ASSERT_EQ(stream.compression(), Compression::Zstd);
+    ASSERT_EQ(read, text);
+
+    TempInput truncated(compressed.substr(0, compressed.size() / 2));
+    DecodingStream truncated_stream(truncated.fd());
+    read.clear();
+    ASSERT_FALSE(readAll(truncated_stream, read));
+    ASSERT_EQ(truncated_stream.error(), "truncated zstd stream");
+}
+#else
+TEST(DecodingStreamTest, RejectsZstdWithoutLibzstd) {
+    TempInput input(std::string("\x28\xB5\x2F\xFD", 4) + "frame");
+    DecodingStream stream(input.fd());
+    char buffer[16];
+    ASSERT_EQ(stream.read(buffer, sizeof(buffer)), -1);
+    ASSERT_EQ(stream.error(), "zstd input needs a build with libzstd (make ZSTD=1)");
+}
+#endif
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <string>
+
+#include "../src/field_parsers.h"
+
+TEST(FieldParsersTest, ParsesNineDecimalPrice) {
+    FixedPrice price;
+    ASSERT_TRUE(parseFixedPrice("5.510000000", price));
+    ASSERT_EQ(price.units, 5510000000LL);
+}
+
+TEST(FieldParsersTest, ParsesShortAndSignedPrices) {
+    ASSERT_EQ(parseFixedPrice("12").units, 12 * kPriceScale);
+    ASSERT_EQ(parseFixedPrice("0.5").units, kPriceScale / 2);
+    ASSERT_EQ(parseFixedPrice("-1.25").units, -1250000000LL);
+    ASSERT_EQ(parseFixedPrice("1.0000000019").units, 1000000001LL);
+}
+
+TEST(FieldParsersTest, RejectsMalformedPrices) {
+    FixedPrice price{7};
+    ASSERT_FALSE(parseFixedPrice("", price));
+    ASSERT_FALSE(parseFixedPrice(".", price));
+    ASSERT_FALSE(parseFixedPrice("1.2x", price));
+    ASSERT_EQ(price.units, 7);
+}
+
+TEST(FieldParsersTest, MatchesAtofWhenConvertedToDouble) {
+    for (const char* text : {"5.510000000", "12.785000000", "21.330000000", "0.000000001", "99999.999999999"}) {
+        ASSERT_EQ(parseFixedPrice(text).toDouble(), std::atof(text)) << text;
+    }
+}
+
+TEST(FieldParsersTest, TimestampRoundTrip) {
+    int64_t ns = 0;
+    ASSERT_TRUE(parseTimestamp("2025-07-17T08:05:03.360677248Z", ns));
+    ASSERT_EQ(ns, 1752739503360677248LL);
+
+    char text[kTimestampLength];
+    ASSERT_EQ(formatTimestamp(ns, text), kTimestampLength);
+    ASSERT_EQ(std::string(text, kTimestampLength), "2025-07-17T08:05:03.360677248Z");
+
+    ASSERT_TRUE(parseTimestamp("1970-01-01T00:00:01.5Z", ns));
+    ASSERT_EQ(ns, 1500000000LL);
+    ASSERT_FALSE(parseTimestamp("2025-07-17 08:05:03Z", ns));
+}
+
+TEST(FieldParsersTest, FixedTimestampPathMatchesGenericParser) {
+    for (const char* text : {"2024-02-29T23:59:59.999999999Z", "1970-01-01T00:00:00.000000000Z",
+                             "2025-07-17T08:05:03.360677248Z", "2099-12-31T12:34:56.000000001Z"}) {
+        int64_t fast = 0;
+        int64_t generic = 0;
+        ASSERT_TRUE(parseTimestampFixed(text, fast)) << text;
+        ASSERT_TRUE(parseTimestampGeneric(text, generic)) << text;
+        ASSERT_EQ(fast, generic) << text;
+    }
+    int64_t fast = 0;
+    ASSERT_FALSE(parseTimestampFixed("2024-02-29T23:59:59.99999999xZ", fast));
+    ASSERT_FALSE(parseTimestampFixed("2024-02-29T23:5a:59.999999999Z", fast));
+    ASSERT_FALSE(parseTimestampFixed("2024-02-29T23:59:59.999999999+", fast));
+    ASSERT_FALSE(parseTimestampFixed("2024-13-29T23:59:59.999999999Z", fast));
+
+    // Layouts only the generic parser accepts: parseTimestamp() falls back to it.
+    for (const char* text : {"2024-02-29T23:59:59.9Z", "2024-02-29T23:59:59Z", "2024-02-29T23:59:59.999999999",
+                             "2024-02-29T23:59:59.9999999999Z"}) {
+        int64_t generic = 0;
+        int64_t parsed = 0;
+        ASSERT_FALSE(parseTimestampFixed(text, fast)) << text;
+        ASSERT_TRUE(parseTimestampGeneric(text, generic)) << text;
+        ASSERT_TRUE(parseTimestamp(text, parsed)) << text;
+        ASSERT_EQ(parsed, generic) << text;
+    }
+    int64_t generic = 0;
+    ASSERT_TRUE(parseTimestampGeneric("2024-02-29T23:59:59.9Z", generic));
+    ASSERT_EQ(generic, 1709251199900000000LL);
+}
+
+TEST(FieldParsersTest, TimestampsRejectOutOfRangeFieldsOnBothPaths) {
+    for (const char* text : {"2024-01-01T99:99:99.000000000Z", "2024-01-01T24:00:00.000000000Z",
+                             "2024-01-01T23:60:00.000000000Z", "2024-01-01T23:59:61.000000000Z",
+                             "2024-00-01T00:00:00.000000000Z", "2024-01-32T00:00:00.000000000Z"}) {
+        int64_t ns = 0;
+        ASSERT_FALSE(parseTimestampFixed(text, ns)) << text;
+        ASSERT_FALSE(parseTimestampGeneric(text, ns)) << text;
+        ASSERT_FALSE(parseTimestampGeneric(std::string(text).substr(0, 19) + "Z", ns)) << text;
+    }
+    // A leap second is in range on both paths.
+    int64_t fast = 0;
+    int64_t generic = 0;
+    ASSERT_TRUE(parseTimestampFixed("2016-12-31T23:59:60.000000000Z", fast));
+    ASSERT_TRUE(parseTimestampGeneric("2016-12-31T23:59:60Z", generic));
+    ASSERT_EQ(fast, generic);
+}
@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unistd.h>
+
+#include "../src/input_source.h"
+
+namespace {
+
+// Feeds `text` to a LineAssembler in pieces of `piece` bytes and returns the
+// runs it hands out, finishing with any final partial line.
+std::vector<std::string> assemble(std::string_view text, size_t piece) {
+    LineAssembler lines;
+    std::vector<std::string> runs;
+    auto sink = [&runs](std::string_view run) {
+        runs.emplace_back(run);
+        return true;
+    };
+    for (size_t i = 0; i < text.size(); i += piece) EXPECT_TRUE(lines.feed(text.substr(i, piece), sink));
+    EXPECT_TRUE(lines.finish(sink));
+    return runs;
+}
+
+std::string joined(const std::vector<std::string>& runs) {
+    std::string text;
+    for (const std::string& run : runs) text += run;
+    return text;
+}
+
+// Writes `text` to a fresh temp file and removes it again on destruction.
+class TempFile {
+public:
+    explicit TempFile(const std::string& text) {
+        int fd = ::mkstemp(path_);
+        EXPECT_GE(fd, 0);
+        EXPECT_EQ(::write(fd, text.data(), text.size()), static_cast<ssize_t>(text.size()));
+        ::close(fd);
+    }
+    ~TempFile() { ::unlink(path_); }
+
+    const char* path() const { return path_; }
+
+private:
+    char path_[32] = "/tmp/input_source_testXXXXXX";
+};
+
+} // namespace
+
+TEST(LineAssemblerTest, HandsOutWholeLinesAcrossChunkBoundaries) {
+    const std::string text = "ts,action\nA,1\nC,22\nF,333\n";
+    for (size_t piece = 1; piece <= text.size(); ++piece) {
+        std::vector<std::string> runs = assemble(text, piece);
+        ASSERT_EQ(joined(runs), text) << piece;
+        for (const std::string& run : runs) ASSERT_EQ(run.back(), '\n') << piece;
+    }
+}
+
+TEST(LineAssemblerTest, FlushesFinalLineWithoutNewline) {
+    std::vector<std::string> runs = assemble("A,1\nC,2", 3);
+    ASSERT_EQ(joined(runs), "A,1\nC,2");
+    ASSERT_EQ(runs.back(), "C,2");
+}
+
+TEST(LineAssemblerTest, KeepsCarriageReturnsWithTheirLines) {
+    const std::string text = "A,1\r\nC,2\r\nF,3\r";
+    std::vector<std::string> runs = assemble(text, 4);
+    ASSERT_EQ(joined(runs), text);
+    ASSERT_EQ(runs.back(), "F,3\r");
+}
+
+TEST(LineAssemblerTest, StopsWhenTheSinkFails) {
+    LineAssembler lines;
+    int calls = 0;
+    auto refuse = [&calls](std::string_view) {
+        ++calls;
+        return false;
+    };
+    ASSERT_TRUE(lines.feed("A,1", refuse)); // no complete line yet
+    ASSERT_FALSE(lines.feed("\nC,2\n", refuse));
+    ASSERT_EQ(calls, 1);
+    ASSERT_TRUE(LineAssembler().finish(refuse)); // nothing to flush
+}
+
+TEST(LineAssemblerTest, RejectsLinesLongerThanTheLimit) {
+    auto accept = [](std::string_view) { return true; };
+    LineAssembler lines(8);
+    ASSERT_TRUE(lines.feed("A,1\nC,2", accept));
+    ASSERT_TRUE(lines.feed("2345\n", accept)); // "C,22345\n" is exactly 8 bytes
+    ASSERT_FALSE(lines.lineTooLong());
+    ASSERT_TRUE(lines.feed("F,33", accept));
+    ASSERT_FALSE(lines.feed("33333", accept)); // still no newline past 8 bytes
+    ASSERT_TRUE(lines.lineTooLong());
+
+    LineAssembler unterminated(8);
+    ASSERT_FALSE(unterminated.feed("A,1\nno newline at all", accept));
+    ASSERT_TRUE(unterminated.lineTooLong());
+}
+
+TEST(InputFileTest, MapsRegularFileAndViewsItsContents) {
+    std::string text = "ts_event,action\n";
+    for (int i = 0; i < 5000; ++i) text += "2025-07-17T08:05:03.360677248Z,A\n";
+    TempFile file(text);
+
+    InputFile input;
+    ASSERT_TRUE(input.open(file.path(), true));
+    ASSERT_TRUE(input.isMapped());
+    ASSERT_EQ(input.view(), text);
+}
+
+TEST(InputFileTest, ReadFallbackViewsTheSameContents) {
+    std::string text;
+    for (int i = 0; i < 20000; ++i) text += "line " + std::to_string(i) + "\r\n";
+    TempFile file(text); // larger than the 64 KB read chunk
+
+    InputFile input;
+    ASSERT_TRUE(input.open(file.path(), false));
+    ASSERT_FALSE(input.isMapped());
+    ASSERT_EQ(input.view(), text);
+}
+
+TEST(InputFileTest, EmptyFileGivesEmptyViewOnBothPaths) {
+    TempFile file("");
+    for (bool use_mmap : {true, false}) {
+        InputFile input;
+        ASSERT_TRUE(input.open(file.path(), use_mmap)) << use_mmap;
+        ASSERT_FALSE(input.isMapped()) << use_mmap; // a zero-length file cannot be mapped
+        ASSERT_TRUE(input.view().empty()) << use_mmap;
+    }
+}
+
+TEST(InputFileTest, FailsOnMissingFile) {
+    InputFile input;
+    ASSERT_FALSE(input.open("/nonexistent/mbo.csv", true));
+    ASSERT_TRUE(input.view().empty());
+}
+
+TEST(ChunkedReaderTest, DeliversFileInOrderInFixedChunks) {
+    char path[] = "/tmp/input_source_testXXXXXX";
+    int fd = ::mkstemp(path);
+    ASSERT_GE(fd, 0);
+    std::string text;
+    for (int i = 0; i < 1000; ++i) text += "line " + std::to_string(i) + "\n";
+    ASSERT_EQ(::write(fd, text.data(), text.size()), static_cast<ssize_t>(text.size()));
+    ::lseek(fd, 0, SEEK_SET);
+
+    std::string read;
+    {
+        ChunkedReader reader(fd, 64, 2);
+        for (std::string_view chunk = reader.next(); !chunk.empty(); chunk = reader.next()) {
+            ASSERT_LE(chunk.size(), 64u);
+            read.append(chunk);
+        }
+        ASSERT_FALSE(reader.failed());
+    }
+    ::close(fd);
+    ::unlink(path);
+    ASSERT_EQ(read, text);
+}
+
+TEST(ChunkedReaderTest, ReportsFillErrorAfterTheDataBeforeIt) {
+    int calls = 0;
+    ChunkedReader reader(
+        [&calls](char* buffer, size_t capacity) -> long {
+            if (calls++ > 0) return -1;
+            buffer[0] = 'x';
+            return capacity > 0 ? 1 : 0;
+        },
+        16);
+    ASSERT_EQ(reader.next(), "x");
+    ASSERT_TRUE(reader.next().empty());
+    ASSERT_TRUE(reader.failed());
+}
+
+TEST(ChunkedReaderTest, ReportsReadErrorOnBadDescriptor) {
+    ChunkedReader reader(-1, 16);
+    ASSERT_TRUE(reader.next().empty());
+    ASSERT_TRUE(reader.failed());
+}
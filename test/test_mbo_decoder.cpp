@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <string>
+
+#include "../src/mbo_decoder.h"
+
+namespace {
+
+const std::string kAddLine =
+    "2025-07-17T08:05:03.360842448Z,2025-07-17T08:05:03.360677248Z,160,2,1108,A,B,5.510000000,100,0,817593,130,165200,851012,ARL\n";
+
+} // namespace
+
+TEST(MboDecoderTest, ProjectsBookColumns) {
+    StructuralScanner scanner;
+    scanner.scan(kAddLine);
+    CsvRecord record;
+    ASSERT_TRUE(scanner.next(record));
+
+    MboEvent event;
+    ASSERT_TRUE(MboCsvDecoder().decode(record, event));
+    ASSERT_EQ(event.ts_event, 1752739503360677248LL); // 2025-07-17T08:05:03.360677248Z
+    ASSERT_EQ(event.action, 'A');
+    ASSERT_EQ(event.side, 'B');
+    ASSERT_EQ(event.price.units, 5510000000LL);
+    ASSERT_EQ(event.size, 100);
+    ASSERT_EQ(event.order_id, 817593);
+    ASSERT_EQ(event.publisher_id, 2);
+    ASSERT_EQ(event.instrument_id, 1108u);
+    ASSERT_EQ(event.flags, 130);
+    ASSERT_EQ(event.ts_in_delta, 165200);
+    ASSERT_EQ(event.sequence, 851012u);
+    ASSERT_EQ(event.symbol, "ARL");
+}
+
+TEST(MboDecoderTest, RejectsShortLinesAndBadTimestampsAndDefaultsEmptySide) {
+    StructuralScanner scanner;
+    scanner.scan("a,b,c\n"
+                 "ts,2025-07-17 07:05:09,160,2,1108,R,,,0,0,0,8,0,0,ARL\n"
+                 "ts,2025-07-17T07:05:09.035627674Z,160,2,1108,R,,,0,0,0,8,0,0,ARL\n");
+    CsvRecord record;
+    MboEvent event;
+    MboCsvDecoder decoder;
+
+    ASSERT_TRUE(scanner.next(record));
+    ASSERT_FALSE(decoder.decode(record, event));
+
+    ASSERT_TRUE(scanner.next(record));
+    ASSERT_FALSE(decoder.decode(record, event));
+
+    ASSERT_TRUE(scanner.next(record));
+    ASSERT_TRUE(decoder.decode(record, event));
+    ASSERT_EQ(event.action, 'R');
+    ASSERT_EQ(event.side, 'N');
+    ASSERT_EQ(event.order_id, 0);
+}
+
+TEST(MboDecoderTest, HeaderPlanHandlesReorderedColumns) {
+    MboColumnPlan plan;
+    std::string_view missing;
+    ASSERT_TRUE(MboColumnPlan::fromHeader("order_id,venue,side,size,price,action,ts_event\r", plan, missing));
+    ASSERT_EQ(plan[MboField::OrderId], 0u);
+    ASSERT_EQ(plan[MboField::TsEvent], 6u);
+    ASSERT_EQ(plan.min_fields, 7u);
+
+    StructuralScanner scanner;
+    scanner.scan("42,XNAS,A,7,21.330000000,A,1970-01-01T00:00:09.000000000Z\n");
+    CsvRecord record;
+    ASSERT_TRUE(scanner.next(record));
+
+    MboEvent event;
+    ASSERT_TRUE(MboCsvDecoder(plan).decode(record, event));
+    ASSERT_EQ(event.order_id, 42);
+    ASSERT_EQ(event.side, 'A');
+    ASSERT_EQ(event.size, 7);
+    ASSERT_EQ(event.price.units, 21330000000LL);
+    ASSERT_EQ(event.action, 'A');
+    ASSERT_EQ(event.ts_event, 9 * kNanosPerSecond);
+}
+
+TEST(MboDecoderTest, HeaderPlanReportsMissingColumn) {
+    MboColumnPlan plan;
+    std::string_view missing;
+    ASSERT_FALSE(MboColumnPlan::fromHeader("ts_event,action,side,price,size", plan, missing));
+    ASSERT_EQ(missing, "order_id");
+}
+
+TEST(MboDecoderTest, StripsCarriageReturnFromWhicheverColumnIsLast) {
+    MboColumnPlan plan;
+    std::string_view missing;
+    ASSERT_TRUE(MboColumnPlan::fromHeader("ts_event,action,side,size,order_id,price\r", plan, missing));
+
+    StructuralScanner scanner;
+    scanner.scan("2025-07-17T08:05:03.360677248Z,A,B,100,817593,5.510000000\r\n"
+                 "2025-07-17T08:05:03.360677248Z,A,A,7,817594,21.33\r\n");
+    CsvRecord record;
+    MboEvent event;
+    MboCsvDecoder decoder(plan);
+
+    ASSERT_TRUE(scanner.next(record));
+    ASSERT_TRUE(decoder.decode(record, event));
+    ASSERT_EQ(event.price.units, 5510000000LL);
+    ASSERT_EQ(event.order_id, 817593);
+
+    ASSERT_TRUE(scanner.next(record));
+    ASSERT_TRUE(decoder.decode(record, event));
+    ASSERT_EQ(event.price.units, 21330000000LL);
+}
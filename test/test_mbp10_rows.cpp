@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../src/book_manager.h"
+#include "../src/mbp10_rows.h"
+#include "../src/order_book.h"
+
+namespace {
+
+using Book = BasicOrderBook<int64_t, MapLevels, FlatOrders, 20>;
+
+MboEvent event(uint32_t instrument, char action, char side, long long id, const char* price, int size) {
+    MboEvent e;
+    e.action = action;
+    e.side = side;
+    e.order_id = id;
+    e.price = parseFixedPrice(price);
+    e.size = size;
+    e.instrument_id = instrument;
+    return e;
+}
+
+// Both books see the same shape of session: a resting bid and ask, a trade
+// that hits the ask (T, F, C), and a later add. Ids are offset per instrument.
+std::vector<MboEvent> session(uint32_t instrument) {
+    const long long base = instrument * 100;
+    return {
+        event(instrument, 'A', 'B', base + 1, "10.00", 5),
+        event(instrument, 'A', 'A', base + 2, "10.50", 8),
+        event(instrument, 'T', 'B', base + 2, "10.50", 3),
+        event(instrument, 'F', 'A', base + 2, "10.50", 3),
+        event(instrument, 'C', 'A', base + 2, "10.50", 3),
+        event(instrument, 'A', 'B', base + 3, "10.10", 2),
+        event(instrument, 'T', 'A', base + 1, "10.00", 1),
+        event(instrument, 'F', 'B', base + 1, "10.00", 1),
+        event(instrument, 'C', 'B', base + 1, "10.00", 1),
+    };
+}
+
+// The MBP-10 rows of each instrument, without the row number and the two
+// timestamps (all zero here), so that rows can be compared across runs.
+std::map<uint32_t, std::vector<std::string>> rowsByInstrument(const std::vector<MboEvent>& events) {
+    BookManager<Book, PendingTrade> books;
+    std::map<uint32_t, std::vector<std::string>> rows;
+    auto rowWriter = [&rows](BookManager<Book, PendingTrade>::Entry& entry) {
+        return [&rows, &entry](const MboEvent& row, int depth) {
+            SnapshotLevel bids[Book::kDepth];
+            SnapshotLevel asks[Book::kDepth];
+            entry.book.writeLevels(bids, asks);
+            char text[maxMbp10CsvBytes()];
+            const std::string line(text, writeMbp10Csv(text, 0, row, depth, bids, asks, "") - text);
+            rows[entry.instrument_id].push_back(line.substr(2 + 2 * (kTimestampLength + 1)));
+        };
+    };
+    for (const MboEvent& e : events) {
+        auto& entry = books.bookFor(e);
+        applyMbp10Event(entry.book, entry.state, e, rowWriter(entry));
+    }
+    for (size_t i = 0; i < books.size(); ++i) flushMbp10Trade(books[i].book, books[i].state, rowWriter(books[i]));
+    return rows;
+}
+
+} // namespace
+
+TEST(Mbp10RowsTest, MergesTradeFillAndCancelIntoOneRow) {
+    std::vector<std::string> rows = rowsByInstrument(session(1))[1];
+    // The event columns and the first two levels of each side.
+    for (std::string& row : rows) {
+        size_t end = 0;
+        for (int field = 0; field < 23; ++field) end = row.find(',', end) + 1;
+        row.resize(end - 1);
+    }
+    const std::vector<std::string> expected = {
+        "10,0,1,A,B,0,10.0,5,0,0,0,10.0,5,1,,0,0,,0,0,,0,0",
+        "10,0,1,A,A,0,10.5,8,0,0,0,10.0,5,1,10.5,8,1,,0,0,,0,0",
+        // The trade row is on the resting order's side and shows the book
+        // after the fill: 5 of the 8 remain, the cancel does not remove them.
+        "10,0,1,T,A,0,10.5,3,0,0,0,10.0,5,1,10.5,5,1,,0,0,,0,0",
+        "10,0,1,A,B,0,10.1,2,0,0,0,10.1,2,1,10.5,5,1,10.0,5,1,,0,0",
+        // Still pending at the end of the input: written by flushMbp10Trade().
+        "10,0,1,T,B,1,10.0,1,0,0,0,10.1,2,1,10.5,5,1,10.0,4,1,,0,0",
+    };
+    ASSERT_EQ(rows, expected);
+}
+
+TEST(Mbp10RowsTest, InterleavedInstrumentsKeepTheirOwnPendingTrade) {
+    const std::vector<MboEvent> first = session(1);
+    const std::vector<MboEvent> second = session(2);
+    std::vector<MboEvent> interleaved;
+    for (size_t i = 0; i < first.size(); ++i) {
+        interleaved.push_back(first[i]);
+        interleaved.push_back(second[i]);
+    }
+
+    std::map<uint32_t, std::vector<std::string>> together = rowsByInstrument(interleaved);
+    ASSERT_EQ(together[1], rowsByInstrument(first)[1]);
+    ASSERT_EQ(together[2], rowsByInstrument(second)[2]);
+}
+
+TEST(Mbp10RowsTest, ChangesBelowTheLastLevelGetNoRowOnEitherSide) {
+    // Twelve levels a side, one order each except the twelfth, which has two.
+    std::vector<MboEvent> events;
+    const char* bid_prices[] = {"20", "19", "18", "17", "16", "15", "14", "13", "12", "11", "10", "9"};
+    const char* ask_prices[] = {"21", "22", "23", "24", "25", "26", "27", "28", "29", "30", "31", "32"};
+    for (int i = 0; i < 12; ++i) {
+        events.push_back(event(1, 'A', 'B', 1 + i, bid_prices[i], 1));
+        events.push_back(event(1, 'A', 'A', 101 + i, ask_prices[i], 1));
+    }
+    events.push_back(event(1, 'A', 'B', 13, "9", 1));
+    events.push_back(event(1, 'A', 'A', 113, "32", 1));
+    const size_t setup_rows = rowsByInstrument(events)[1].size();
+
+    for (char side : {'B', 'A'}) {
+        const long long id = side == 'B' ? 12 : 112;
+        const char* price = side == 'B' ? "9" : "32";
+        events.push_back(event(1, 'C', side, id, price, 1));     // the level keeps another order
+        events.push_back(event(1, 'C', side, id + 1, price, 1)); // the level goes away
+    }
+    ASSERT_EQ(rowsByInstrument(events)[1].size(), setup_rows);
+
+    events.push_back(event(1, 'C', 'B', 11, "10", 1)); // level 10 is still reported
+    std::vector<std::string> rows = rowsByInstrument(events)[1];
+    ASSERT_EQ(rows.size(), setup_rows + 1);
+    ASSERT_EQ(rows.back().substr(0, 23), "10,0,1,C,B,10,10.0,1,0,");
+}
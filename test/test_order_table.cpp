@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <unordered_map>
+
+#include "../src/order_table.h"
+
+TEST(OrderTableTest, InsertFindErase) {
+    OrderTable<int> table;
+    table.insertOrAssign(42, 1);
+    table.insertOrAssign(43, 2);
+    table.insertOrAssign(42, 3); // replaces
+    ASSERT_EQ(table.size(), 2u);
+    ASSERT_EQ(*table.find(42), 3);
+    ASSERT_EQ(table.find(44), nullptr);
+
+    table.erase(table.find(42));
+    ASSERT_EQ(table.find(42), nullptr);
+    ASSERT_EQ(*table.find(43), 2);
+    ASSERT_EQ(table.size(), 1u);
+}
+
+TEST(OrderTableTest, EmptyMarkerKeyIsNeverFound) {
+    OrderTable<int> table;
+    ASSERT_EQ(table.find(0), nullptr);
+    table.insertOrAssign(1, 1);
+    table.insertOrAssign(2, 2);
+    ASSERT_EQ(table.find(0), nullptr); // must not match an empty slot
+    ASSERT_EQ(table.size(), 2u);
+
+    OrderTable<int, -1> prices;
+    prices.insertOrAssign(0, 7);
+    ASSERT_EQ(*prices.find(0), 7);
+    ASSERT_EQ(prices.find(-1), nullptr);
+}
+
+TEST(OrderTableTest, ReserveAvoidsGrowth) {
+    OrderTable<int> table;
+    table.reserve(10000);
+    const size_t capacity = table.capacity();
+    for (long long id = 1; id <= 10000; ++id) table.insertOrAssign(id, static_cast<int>(id));
+    ASSERT_EQ(table.capacity(), capacity);
+}
+
+TEST(OrderTableTest, MatchesUnorderedMapUnderChurn) {
+    // Random adds and removes over a small id range keep clusters long and
+    // exercise backward-shift deletion and growth.
+    OrderTable<int> table;
+    std::unordered_map<long long, int> reference;
+    std::mt19937_64 rng(7);
+    for (int step = 0; step < 200000; ++step) {
+        long long id = static_cast<long long>(rng() % 5000) + 1;
+        if (rng() % 3 != 0) {
+            table.insertOrAssign(id, step);
+            reference[id] = step;
+        } else if (int* value = table.find(id)) {
+            ASSERT_EQ(*value, reference.at(id));
+            table.erase(value);
+            reference.erase(id);
+        } else {
+            ASSERT_EQ(reference.count(id), 0u);
+        }
+    }
+    ASSERT_EQ(table.size(), reference.size());
+    for (const auto& [id, value] : reference) ASSERT_EQ(*table.find(id), value);
+}
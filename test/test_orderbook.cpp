@@ -1,131 +1,55 @@
 #include <gtest/gtest.h>
-#include <sstream>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
-// Include the header file where OrderBook is defined.
-// For simplicity here, we assume the class definition is accessible.
-// In a real project, you'd include a header file, e.g., "OrderBook.h".
-// For this trial, we'll just paste the class definition here.
-
-class OrderBook {
-public:
-    struct Order {
-        double price;
-        int size;
-        char side;
-    };
-
-    void addOrder(long long order_id, double price, int size, char side) {
-        if (order_id != 0 && size > 0) {
-            order_map[order_id] = {price, size, side};
-            updateBook(side, price, size);
-        }
-    }
-
-    void cancelOrder(long long order_id) {
-        if (order_map.count(order_id)) {
-            const auto& ord = order_map.at(order_id);
-            updateBook(ord.side, ord.price, -ord.size);
-            order_map.erase(order_id);
-        }
-    }
-
-    void fillOrder(long long order_id, int size) {
-        if (order_map.count(order_id) && size > 0) {
-            auto& ord = order_map.at(order_id);
-            updateBook(ord.side, ord.price, -size);
-            ord.size -= size;
-            if (ord.size <= 0) {
-                order_map.erase(order_id);
-            }
-        }
-    }
-    
-    void reset() {
-        order_map.clear();
-        bid_book.clear();
-        ask_book.clear();
-    }
-
-    void writeSnapshot(std::stringstream& oss, std::string_view ts) const {
-        oss << ts;
-        int count = 0;
-        for (const auto& [price, size] : bid_book) {
-            if (count >= 10) break;
-            oss << "," << std::fixed << std::setprecision(2) << price << "," << size;
-            count++;
-        }
-        for (int i = count; i < 10; ++i) oss << ",,";
-        count = 0;
-        for (const auto& [price, size] : ask_book) {
-            if (count >= 10) break;
-            oss << "," << std::fixed << std::setprecision(2) << price << "," << size;
-            count++;
-        }
-        for (int i = count; i < 10; ++i) oss << ",,";
-        oss << "\n";
-    }
-
-private:
-    std::unordered_map<long long, Order> order_map;
-    std::map<double, int, std::greater<double>> bid_book;
-    std::map<double, int> ask_book;
-
-    void updateBook(char side, double price, int size_diff) {
-        if (side == 'B') {
-            bid_book[price] += size_diff;
-            if (bid_book[price] <= 0) bid_book.erase(price);
-        } else if (side == 'A') {
-            ask_book[price] += size_diff;
-            if (ask_book[price] <= 0) ask_book.erase(price);
-        }
-    }
-};
+#include "../src/order_book.h"
+
+// One snapshot row of `book` stamped `ts`, as the reconstructor writes it.
+template <typename Book>
+std::string snapshotRow(const Book& book, std::string_view ts, bool with_counts = false) {
+    char levels[Book::kMaxLevelsBytes];
+    return std::string(ts) + std::string(levels, book.writeLevels(levels, with_counts) - levels) + "\n";
+}
 
 // Test fixture for OrderBook tests
 class OrderBookTest : public ::testing::Test {
 protected:
     OrderBook book;
-    std::stringstream ss;
 };
 
 TEST_F(OrderBookTest, HandlesSingleAdd) {
     book.addOrder(101, 100.50, 10, 'B');
-    book.writeSnapshot(ss, "T1");
     // CORRECTED: The expected string now matches the actual output from the log.
-    ASSERT_EQ(ss.str(), "T1,100.50,10,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,\n");
+    ASSERT_EQ(snapshotRow(book, "T1"), "T1,100.50,10,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,\n");
 }
 
 TEST_F(OrderBookTest, HandlesBidAndAsk) {
     book.addOrder(101, 100.50, 10, 'B');
     book.addOrder(102, 101.00, 20, 'A');
-    book.writeSnapshot(ss, "T2");
-    ASSERT_EQ(ss.str(), "T2,100.50,10,,,,,,,,,,,,,,,,,,,101.00,20,,,,,,,,,,,,,,,,,,\n");
+    ASSERT_EQ(snapshotRow(book, "T2"), "T2,100.50,10,,,,,,,,,,,,,,,,,,,101.00,20,,,,,,,,,,,,,,,,,,\n");
 }
 
 TEST_F(OrderBookTest, HandlesCancelOrder) {
     book.addOrder(101, 100.50, 10, 'B');
     book.addOrder(102, 101.00, 20, 'A');
     book.cancelOrder(101); // Cancel the bid
-    book.writeSnapshot(ss, "T3");
     // CORRECTED: The expected string now matches the actual output from the log.
-    ASSERT_EQ(ss.str(), "T3,,,,,,,,,,,,,,,,,,,,,101.00,20,,,,,,,,,,,,,,,,,,\n");
+    ASSERT_EQ(snapshotRow(book, "T3"), "T3,,,,,,,,,,,,,,,,,,,,,101.00,20,,,,,,,,,,,,,,,,,,\n");
 }
 
 TEST_F(OrderBookTest, HandlesPartialFill) {
     book.addOrder(101, 100.50, 10, 'B');
     book.fillOrder(101, 4); // Partially fill the bid
-    book.writeSnapshot(ss, "T4");
     // CORRECTED: The expected string now matches the actual output from the log.
-    ASSERT_EQ(ss.str(), "T4,100.50,6,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,\n");
+    ASSERT_EQ(snapshotRow(book, "T4"), "T4,100.50,6,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,\n");
 }
 
 TEST_F(OrderBookTest, HandlesFullFill) {
     book.addOrder(101, 100.50, 10, 'B');
     book.fillOrder(101, 10); // Fully fill the bid
-    book.writeSnapshot(ss, "T5");
-    ASSERT_EQ(ss.str(), "T5,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,\n");
+    ASSERT_EQ(snapshotRow(book, "T5"), "T5,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,\n");
 }
 
 TEST_F(OrderBookTest, HandlesComplexSequence) {
@@ -137,14 +61,161 @@ TEST_F(OrderBookTest, HandlesComplexSequence) {
     book.cancelOrder(4); // Cancel order 4
     book.addOrder(5, 99.5, 30, 'B'); // Add to existing price level
     
-    book.writeSnapshot(ss, "T6");
     // Expected: Bid 99.5 (10+30=40), Bid 99.0 (10), Ask 100.5 (20)
-    ASSERT_EQ(ss.str(), "T6,99.50,40,99.00,10,,,,,,,,,,,,,,,,,100.50,20,,,,,,,,,,,,,,,,,,\n");
+    ASSERT_EQ(snapshotRow(book, "T6"), "T6,99.50,40,99.00,10,,,,,,,,,,,,,,,,,100.50,20,,,,,,,,,,,,,,,,,,\n");
 }
 
 TEST_F(OrderBookTest, HandlesReset) {
     book.addOrder(101, 100.50, 10, 'B');
     book.reset();
-    book.writeSnapshot(ss, "T7");
-    ASSERT_EQ(ss.str(), "T7,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,\n");
+    ASSERT_EQ(snapshotRow(book, "T7"), "T7,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,\n");
+}
+
+TEST_F(OrderBookTest, AppliesDecodedEvents) {
+    MboEvent add;
+    add.action = 'A';
+    add.side = 'A';
+    add.order_id = 7;
+    add.price = parseFixedPrice("101.000000000");
+    add.size = 20;
+    book.apply(add);
+
+    MboEvent trade = add;
+    trade.action = 'T';
+    book.apply(trade); // Trades never touch the book
+
+    MboEvent fill = add;
+    fill.action = 'F';
+    fill.size = 5;
+    book.apply(fill);
+
+    ASSERT_EQ(snapshotRow(book, "T8"), "T8,,,,,,,,,,,,,,,,,,,,,101.00,15,,,,,,,,,,,,,,,,,,\n");
+}
+
+TEST_F(OrderBookTest, EquivalentPriceStringsShareALevel) {
+    book.addOrder(1, parseFixedPrice("12.3"), 10, 'B');
+    book.addOrder(2, parseFixedPrice("12.300000000"), 5, 'B');
+    book.addOrder(3, 12.3, 1, 'B');
+    ASSERT_EQ(snapshotRow(book, "T9"), "T9,12.30,16,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,\n");
+}
+
+TEST(DoubleOrderBookTest, MatchesFixedPointSnapshots) {
+    OrderBook fixed;
+    DoubleOrderBook floating;
+    fixed.addOrder(1, 99.5, 10, 'B');
+    floating.addOrder(1, 99.5, 10, 'B');
+    fixed.addOrder(2, parseFixedPrice("100.25"), 20, 'A');
+    floating.addOrder(2, parseFixedPrice("100.25"), 20, 'A');
+    fixed.fillOrder(2, 5);
+    floating.fillOrder(2, 5);
+    ASSERT_EQ(snapshotRow(fixed, "T10"), snapshotRow(floating, "T10"));
+}
+
+TEST_F(OrderBookTest, WritesLevelOrderCounts) {
+    book.addOrder(1, 99.5, 10, 'B');
+    book.addOrder(2, 99.5, 15, 'B');
+    book.addOrder(3, 99.5, 5, 'B');
+    book.addOrder(4, 100.5, 20, 'A');
+    book.fillOrder(1, 4);  // partial: still three orders
+    book.fillOrder(2, 15); // full: two left
+    book.cancelOrder(4);
+    ASSERT_EQ(snapshotRow(book, "T11", true), "T11,99.50,11,2,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,\n");
+}
+
+TEST_F(OrderBookTest, ReportsChangedDepth) {
+    ASSERT_EQ(book.addOrder(1, 100.0, 10, 'B'), 0);
+    ASSERT_EQ(book.addOrder(2, 99.0, 10, 'B'), 1);
+    ASSERT_EQ(book.addOrder(3, 101.0, 10, 'B'), 0);  // new best pushes the others down
+    ASSERT_EQ(book.fillOrder(2, 4), 2);
+    for (int i = 0; i < 10; ++i) book.addOrder(10 + i, 90.0 - i, 1, 'B');
+    ASSERT_EQ(book.addOrder(30, 50.0, 1, 'B'), kNoVisibleChange); // below the top 10
+    ASSERT_EQ(book.cancelOrder(30), kNoVisibleChange);
+    ASSERT_EQ(book.cancelOrder(999), kNoVisibleChange);
+
+    MboEvent trade;
+    trade.action = 'T';
+    trade.side = 'B';
+    ASSERT_EQ(book.apply(trade), kNoVisibleChange);
+
+    ASSERT_EQ(book.reset(), 0);
+    ASSERT_EQ(book.reset(), kNoVisibleChange);
+}
+
+// --- Depth: snapshots show exactly the book's compile-time depth ---
+
+TEST(OrderBookDepthTest, BestBidOfferOnly) {
+    BasicOrderBook<int64_t, MapLevels, FlatOrders, 1> book;
+    ASSERT_EQ(book.addOrder(1, 100.0, 10, 'B'), 0);
+    ASSERT_EQ(book.addOrder(2, 99.0, 10, 'B'), kNoVisibleChange); // behind the best bid
+    ASSERT_EQ(book.addOrder(3, 101.0, 5, 'A'), 0);
+    ASSERT_EQ(snapshotRow(book, "T1", true), "T1,100.00,10,1,101.00,5,1\n");
+
+    ASSERT_EQ(book.cancelOrder(1), 0); // the next level moves up
+    ASSERT_EQ(snapshotRow(book, "T2"), "T2,99.00,10,101.00,5\n");
+}
+
+TEST(OrderBookDepthTest, PadsMissingLevels) {
+    BasicOrderBook<int64_t, MapLevels, FlatOrders, 5> book;
+    book.addOrder(1, 100.0, 10, 'B');
+    ASSERT_EQ(snapshotRow(book, "T1"), "T1,100.00,10,,,,,,,,,,,,,,,,,,\n");
+}
+
+// --- L3 mode: orders queue in arrival order within each level ---
+
+using L3OrderBook = BasicOrderBook<int64_t, MapLevels, QueuedOrders>;
+
+std::vector<std::pair<long long, int>> queueAt(L3OrderBook& book, char side, double price) {
+    std::vector<std::pair<long long, int>> queue;
+    book.orders().forEachInQueue(side, PriceTraits<int64_t>::fromDouble(price),
+                                 [&queue](long long id, const L3OrderBook::Order& order) { queue.emplace_back(id, order.size); });
+    return queue;
+}
+
+TEST(L3OrderBookTest, KeepsQueuePriority) {
+    L3OrderBook book;
+    book.addOrder(1, 100.0, 10, 'B');
+    book.addOrder(2, 100.0, 20, 'B');
+    book.addOrder(3, 100.0, 30, 'B');
+    book.addOrder(4, 101.0, 5, 'A');
+
+    book.fillOrder(1, 4);   // partial fill keeps its place
+    book.cancelOrder(2);    // middle of the queue
+    book.addOrder(5, 100.0, 7, 'B');
+    std::vector<std::pair<long long, int>> expected = {{1, 6}, {3, 30}, {5, 7}};
+    ASSERT_EQ(queueAt(book, 'B', 100.0), expected);
+
+    book.fillOrder(4, 5);   // full fill empties the ask level
+    ASSERT_TRUE(queueAt(book, 'A', 101.0).empty());
+    ASSERT_EQ(book.orders().size(), 3u);
+
+    ASSERT_EQ(snapshotRow(book, "T1"), "T1,100.00,43,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,\n");
+
+    book.reset();
+    ASSERT_EQ(book.orders().size(), 0u);
+    ASSERT_TRUE(queueAt(book, 'B', 100.0).empty());
+}
+
+TEST(L3OrderBookTest, IgnoresEventsForOrderIdZero) {
+    L3OrderBook book;
+    book.addOrder(1, 100.0, 10, 'B');
+    ASSERT_EQ(book.cancelOrder(0), kNoVisibleChange);
+    ASSERT_EQ(book.fillOrder(0, 5), kNoVisibleChange);
+    ASSERT_EQ(book.orders().size(), 1u);
+    std::vector<std::pair<long long, int>> expected = {{1, 10}};
+    ASSERT_EQ(queueAt(book, 'B', 100.0), expected);
+}
+
+TEST(L3OrderBookTest, ErasesAfterTheTableChangedSinceFind) {
+    QueuedOrders<L3OrderBook::Order> orders;
+    orders.insertOrAssign(1, L3OrderBook::Order{100, 10, 'B'});
+    L3OrderBook::Order* first = orders.find(1);
+    for (long long id = 2; id < 200; ++id) orders.insertOrAssign(id, L3OrderBook::Order{100, 1, 'B'}); // rehashes
+    orders.erase(first);
+    ASSERT_EQ(orders.find(1), nullptr);
+    ASSERT_EQ(orders.size(), 198u);
+
+    orders.erase(orders.find(2)); // straight through the found slot
+    ASSERT_EQ(orders.find(2), nullptr);
+    ASSERT_NE(orders.find(3), nullptr);
+    ASSERT_EQ(orders.size(), 197u);
 }
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../src/output_writer.h"
+
+namespace {
+
+void append(BackgroundWriter& writer, const std::string& text) {
+    std::memcpy(writer.reserve(text.size()), text.data(), text.size());
+    writer.commit(text.size());
+}
+
+std::string readAll(int fd) {
+    std::string text;
+    char buffer[4096];
+    ::lseek(fd, 0, SEEK_SET);
+    for (ssize_t n; (n = ::read(fd, buffer, sizeof(buffer))) > 0;) text.append(buffer, n);
+    return text;
+}
+
+} // namespace
+
+TEST(BackgroundWriterTest, WritesEverythingInOrder) {
+    char path[] = "/tmp/output_writer_testXXXXXX";
+    int fd = ::mkstemp(path);
+    ASSERT_GE(fd, 0);
+    ::unlink(path);
+
+    std::string expected;
+    {
+        // Buffers far smaller than the output, so they cycle many times.
+        BackgroundWriter writer(fd, 64, 3);
+        for (int i = 0; i < 5000; ++i) {
+            std::string row = "row," + std::to_string(i) + "\n";
+            append(writer, row);
+            expected += row;
+        }
+        append(writer, std::string(200, 'x')); // longer than a buffer
+        expected += std::string(200, 'x');
+        ASSERT_TRUE(writer.finish());
+    }
+    ASSERT_EQ(readAll(fd), expected);
+    ::close(fd);
+}
+
+TEST(BackgroundWriterTest, ReportsWriteErrors) {
+    int fd = ::open("/dev/full", O_WRONLY);
+    if (fd < 0) GTEST_SKIP() << "no /dev/full";
+    BackgroundWriter writer(fd, 64);
+    for (int i = 0; i < 100; ++i) append(writer, "some output\n");
+    ASSERT_FALSE(writer.finish());
+    ASSERT_FALSE(writer.error().empty());
+    ::close(fd);
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "../src/price_levels.h"
+
+// The same behaviour is expected from every level container. The tick
+// ladder gets a one-unit tick and a 64-tick window, so the deep book test
+// drives it through re-centering and the overflow map.
+template <typename Levels>
+class PriceLevelsTest : public ::testing::Test {
+protected:
+    Levels levels{LevelConfig{1, 64}};
+
+    std::vector<std::pair<int64_t, int>> best(size_t n) const {
+        std::vector<std::pair<int64_t, int>> out;
+        levels.forEachBest(n, [&out](int64_t price, int size, int) { out.emplace_back(price, size); });
+        return out;
+    }
+};
+
+using BidContainers = ::testing::Types<MapLevels<int64_t, std::greater<int64_t>>,
+                                       VectorLevels<int64_t, std::greater<int64_t>>,
+                                       TickLadder<int64_t, std::greater<int64_t>>>;
+TYPED_TEST_SUITE(PriceLevelsTest, BidContainers);
+
+TYPED_TEST(PriceLevelsTest, KeepsBestPriceFirst) {
+    for (int64_t price : {100, 103, 101, 99, 102}) this->levels.add(price, 1, 1);
+    std::vector<std::pair<int64_t, int>> expected = {{103, 1}, {102, 1}, {101, 1}};
+    ASSERT_EQ(this->best(3), expected);
+    ASSERT_EQ(this->levels.size(), 5u);
+}
+
+TYPED_TEST(PriceLevelsTest, AggregatesAndRemovesEmptyLevels) {
+    this->levels.add(100, 10, 1);
+    this->levels.add(100, 5, 1);
+    this->levels.add(101, 7, 1);
+    this->levels.add(101, -7, -1);
+    this->levels.add(99, -3, -1); // a decrease on a missing level is a no-op
+    std::vector<std::pair<int64_t, int>> expected = {{100, 15}};
+    ASSERT_EQ(this->best(10), expected);
+}
+
+TYPED_TEST(PriceLevelsTest, HandlesDeepBooks) {
+    // Far more levels than the vector container scans linearly.
+    for (int64_t price = 0; price < 200; price += 2) this->levels.add(price, 1, 1);
+    this->levels.add(51, 4, 1);
+    this->levels.add(50, -1, -1);
+    this->levels.add(198, -1, -1);
+    ASSERT_EQ(this->levels.size(), 99u);
+    std::vector<std::pair<int64_t, int>> top = {{196, 1}, {194, 1}};
+    ASSERT_EQ(this->best(2), top);
+
+    size_t seen = 0;
+    int64_t last = 1000;
+    int size_at_51 = 0;
+    this->levels.forEachBest(1000, [&](int64_t price, int size, int) {
+        ASSERT_LT(price, last);
+        last = price;
+        if (price == 51) size_at_51 = size;
+        ++seen;
+    });
+    ASSERT_EQ(seen, 99u);
+    ASSERT_EQ(size_at_51, 4);
+}
+
+TEST(TickLadderTest, RecentersAndOverflows) {
+    TickLadder<int64_t, std::less<int64_t>> asks(LevelConfig{5, 64});
+    asks.add(1000, 1, 1);
+    asks.add(1200, 2, 1); // 40 ticks away: the window re-centers around both
+    ASSERT_EQ(asks.overflowSize(), 0u);
+    asks.add(5000, 3, 1); // too far to fit with the rest
+    asks.add(1003, 4, 1); // off the tick grid
+    ASSERT_EQ(asks.overflowSize(), 2u);
+
+    std::vector<std::pair<int64_t, int>> seen;
+    asks.forEachBest(10, [&seen](int64_t price, int size, int) { seen.emplace_back(price, size); });
+    std::vector<std::pair<int64_t, int>> expected = {{1000, 1}, {1003, 4}, {1200, 2}, {5000, 3}};
+    ASSERT_EQ(seen, expected);
+
+    // Once the near levels are gone the window follows the price, taking the overflow level with it.
+    asks.add(1000, -1, -1);
+    asks.add(1200, -2, -1);
+    asks.add(5005, 6, 1);
+    ASSERT_EQ(asks.overflowSize(), 1u);
+    seen.clear();
+    asks.forEachBest(10, [&seen](int64_t price, int size, int) { seen.emplace_back(price, size); });
+    expected = {{1003, 4}, {5000, 3}, {5005, 6}};
+    ASSERT_EQ(seen, expected);
+}
+
+TYPED_TEST(PriceLevelsTest, TracksOrderCounts) {
+    this->levels.add(100, 10, 1);
+    this->levels.add(100, 5, 1);
+    this->levels.add(100, -3, 0); // partial fill
+    this->levels.add(101, 2, 1);
+    std::vector<std::pair<int64_t, int>> counts;
+    this->levels.forEachBest(10, [&counts](int64_t price, int, int count) { counts.emplace_back(price, count); });
+    std::vector<std::pair<int64_t, int>> expected = {{101, 1}, {100, 2}};
+    ASSERT_EQ(counts, expected);
+}
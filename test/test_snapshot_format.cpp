@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../src/csv_scanner.h"
+#include "../src/order_book.h"
+#include "../src/snapshot_format.h"
+
+TEST(SnapshotFormatTest, BuildsCsvHeader) {
+    SnapshotFormat format;
+    ASSERT_EQ(snapshotCsvHeader(1, format), "ts_event,bid_price_0,bid_size_0,ask_price_0,ask_size_0\n");
+    format.with_depth = true;
+    format.with_counts = true;
+    format.with_symbol = true;
+    ASSERT_EQ(snapshotCsvHeader(1, format),
+              "ts_event,depth,bid_price_0,bid_size_0,bid_ct_0,ask_price_0,ask_size_0,ask_ct_0,symbol\n");
+}
+
+TEST(SnapshotFormatTest, BinaryRecordsConvertToTheSameCsv) {
+    BasicOrderBook<int64_t, MapLevels, FlatOrders, 5> book;
+    book.addOrder(1, 5.51, 100, 'B');
+    book.addOrder(2, 5.51, 20, 'B');
+    book.addOrder(3, 5.40, 7, 'B');
+    const int depth = book.addOrder(4, 21.125, 3, 'A');
+
+    SnapshotRecord<5> record;
+    record.head = SnapshotRecordHead{1752739503360677248LL, 1108, depth};
+    book.writeLevels(record.bids, record.asks);
+    ASSERT_EQ(record.bids[0].price, 5510000000LL);
+    ASSERT_EQ(record.bids[0].size, 120u);
+    ASSERT_EQ(record.bids[0].count, 2u);
+    ASSERT_EQ(record.bids[2].price, kSnapshotNoPrice);
+    ASSERT_EQ(record.asks[0].price, 21125000000LL);
+
+    char bytes[sizeof(record)];
+    std::memcpy(bytes, &record, sizeof(record));
+    SnapshotFormat format;
+    format.with_counts = true;
+    char row[maxSnapshotCsvBytes(5)];
+    std::string converted(row, writeSnapshotCsv(row, bytes, 5, format) - row);
+
+    char expected[maxSnapshotCsvBytes(5)];
+    char* end = expected + formatTimestamp(record.head.ts_event, expected);
+    end = book.writeLevels(end, true);
+    *end++ = '\n';
+    ASSERT_EQ(converted, std::string_view(expected, end - expected));
+
+    format.with_depth = true;
+    converted.assign(row, writeSnapshotCsv(row, bytes, 5, format) - row);
+    ASSERT_EQ(converted.substr(30, 3), ",0,");
+}
+
+TEST(SnapshotFormatTest, HeaderDescribesTheRecords) {
+    SnapshotFileHeader header = makeSnapshotFileHeader(10);
+    ASSERT_EQ(std::memcmp(header.magic, "MBPS", 4), 0);
+    ASSERT_EQ(header.depth, 10);
+    ASSERT_EQ(header.header_bytes, sizeof(SnapshotFileHeader));
+    ASSERT_EQ(header.record_bytes, sizeof(SnapshotRecord<10>));
+    ASSERT_EQ(header.price_scale, kPriceScale);
+}
+
+// --- Delta snapshots ---
+
+namespace {
+
+SnapshotLevel level(int64_t cents, uint32_t size) { return SnapshotLevel{cents * 10000000, size, 1}; }
+const SnapshotLevel kNone = {kSnapshotNoPrice, 0, 0};
+
+std::string deltaEntries(const std::vector<SnapshotLevel>& before, const std::vector<SnapshotLevel>& after) {
+    char text[maxDeltaCsvBytes(4)];
+    return std::string(text, writeDeltaCsv(text, 'B', before.data(), after.data(), before.size(), 0, false) - text);
+}
+
+// Feeds `lines` (after the header) to `reader`, one line at a time.
+bool readLines(DeltaCsvReader& reader, std::string_view lines) {
+    StructuralScanner scanner;
+    scanner.scan(lines);
+    CsvRecord line;
+    while (scanner.next(line)) {
+        if (!reader.apply(line)) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(SnapshotFormatTest, EncodesLevelShiftsAsOneEntry) {
+    std::vector<SnapshotLevel> book = {level(550, 10), level(549, 20), level(548, 30), kNone};
+    std::vector<SnapshotLevel> inserted = {level(551, 5), level(550, 10), level(549, 20), level(548, 30)};
+    std::vector<SnapshotLevel> removed = {level(550, 10), level(548, 30), kNone, kNone};
+    std::vector<SnapshotLevel> resized = {level(550, 10), level(549, 25), level(548, 30), kNone};
+    ASSERT_EQ(deltaEntries(book, inserted), ",IB,0,5.51,5");
+    ASSERT_EQ(deltaEntries(book, removed), ",XB,1");
+    ASSERT_EQ(deltaEntries(book, resized), ",B,1,5.49,25");
+    ASSERT_EQ(deltaEntries(book, book), "");
+}
+
+TEST(SnapshotFormatTest, ReaderRebuildsLevelsFromDeltas) {
+    DeltaCsvReader reader;
+    ASSERT_FALSE(reader.readHeader("ts_event,bid_price_0"));
+    ASSERT_FALSE(reader.readHeader("ts_event,book,type,side,level,price,size"));
+    ASSERT_FALSE(reader.readHeader("ts_event,book,type,side,level,price,size,levels_per_side=0"));
+    ASSERT_FALSE(reader.readHeader("ts_event,book,type,side,level,price,size,levels_per_side=99999999999999999999"));
+    ASSERT_TRUE(reader.readHeader("ts_event,book,type,side,level,price,size,levels_per_side=3"));
+    ASSERT_EQ(reader.depth(), 3u);
+    ASSERT_TRUE(readLines(reader, "2025-07-17T08:05:03.000000000Z,0,K,ARL,5.50,10,5.49,20,,,21.00,5,,,,\n"
+                                  "+5,0,D,IB,0,5.51,7\n"));
+    ASSERT_EQ(reader.changedDepth(), 0);
+    ASSERT_EQ(reader.book().ts_event, 1752739503000000005LL);
+    ASSERT_EQ(reader.book().bids[0].price, 5510000000LL);
+    ASSERT_EQ(reader.book().bids[1].price, 5500000000LL);
+    ASSERT_EQ(reader.book().bids[2].price, 5490000000LL);
+
+    ASSERT_TRUE(readLines(reader, "-2,0,D,XA,0\n"));
+    ASSERT_EQ(reader.book().ts_event, 1752739503000000003LL);
+    ASSERT_EQ(reader.book().asks[0].price, kSnapshotNoPrice);
+    ASSERT_EQ(reader.book().symbol, "ARL");
+
+    ASSERT_TRUE(readLines(reader, "+1,0,D\n"));
+    ASSERT_EQ(reader.changedDepth(), -1);
+
+    ASSERT_FALSE(readLines(reader, "+1,1,D,B,0,5.00,1\n")); // no keyframe for book 1 yet
+    ASSERT_FALSE(readLines(reader, "+1,0,D,B,9,5.00,1\n")); // beyond the depth
+}
+
+TEST(SnapshotFormatTest, WritesVendorMbp10Rows) {
+    const std::string header = mbp10CsvHeader();
+    ASSERT_EQ(header.rfind(",ts_recv,ts_event,rtype,publisher_id,instrument_id,action,side,depth,price,size,flags,"
+                           "ts_in_delta,sequence,bid_px_00,bid_sz_00,bid_ct_00,ask_px_00,ask_sz_00,ask_ct_00,bid_px_01,",
+                           0),
+              0u);
+    ASSERT_NE(header.find(",ask_ct_09,symbol,order_id\r\n"), std::string::npos);
+
+    BasicOrderBook<int64_t, MapLevels, FlatOrders, 20> book;
+    MboEvent add;
+    add.ts_event = 1752739503360677248LL; // 2025-07-17T08:05:03.360677248Z
+    add.action = 'A';
+    add.side = 'B';
+    add.price = FixedPrice{5510000000LL};
+    add.size = 100;
+    add.order_id = 817593;
+    add.flags = 130;
+    add.ts_in_delta = 165200;
+    add.sequence = 851012;
+    add.publisher_id = 2;
+    add.instrument_id = 1108;
+    const int depth = book.apply(add);
+
+    SnapshotLevel bids[20];
+    SnapshotLevel asks[20];
+    book.writeLevels(bids, asks);
+    char row[maxMbp10CsvBytes() + 3];
+    std::string expected = "1,2025-07-17T08:05:03.360677248Z,2025-07-17T08:05:03.360677248Z,10,2,1108,A,B,0,5.51,100,130,"
+                           "165200,851012,5.51,100,1";
+    for (int i = 0; i < 19; ++i) expected += ",,0,0";
+    expected += ",ARL,817593\r\n"; // row 1 of data/mbp.csv
+    ASSERT_EQ(std::string(row, writeMbp10Csv(row, 1, add, depth, bids, asks, "ARL") - row), expected);
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <utility>
+
+#include "../src/text_format.h"
+
+namespace {
+
+std::string printed(double value) {
+    char text[64];
+    std::snprintf(text, sizeof(text), "%.2f", value);
+    return text;
+}
+
+std::string formatted(FixedPrice price) {
+    char text[kMaxPriceChars];
+    return std::string(text, formatPrice2(text, price) - text);
+}
+
+} // namespace
+
+TEST(TextFormatTest, WritesIntegers) {
+    char text[kMaxIntegerChars];
+    for (int64_t value : {int64_t(0), int64_t(7), int64_t(10), int64_t(99), int64_t(100), int64_t(12345),
+                          int64_t(-42), INT64_MAX, INT64_MIN}) {
+        ASSERT_EQ(std::string(text, formatInteger(text, value) - text), std::to_string(value));
+    }
+}
+
+TEST(TextFormatTest, RoundsPricesLikePrintf) {
+    // Decimal ties: 0.125 and 0.375 are exact in binary (half to even), the
+    // others lie just above or below the tie once converted to double.
+    for (int64_t units : {0LL, 5510000000LL, 125000000LL, 375000000LL, 625000000LL, 875000000LL, 5000000LL,
+                          15000000LL, 1005000000LL, 2675000000LL, 12785000000LL, 4999999LL, 5000001LL,
+                          -1LL, -125000000LL, -1005000000LL, -5000000LL, 9007199254740993LL}) {
+        FixedPrice price{units};
+        ASSERT_EQ(formatted(price), printed(price.toDouble())) << units;
+    }
+}
+
+TEST(TextFormatTest, MatchesPrintfOnRandomPrices) {
+    std::mt19937_64 rng(20240717);
+    for (int i = 0; i < 200000; ++i) {
+        // Half the samples sit exactly on a decimal tie (x.xx5).
+        int64_t units = static_cast<int64_t>(rng() % 100000000000ULL);
+        if (i % 2 == 0) units = units / 10000000 * 10000000 + 5000000;
+        if (i % 7 == 0) units = -units;
+        FixedPrice price{units};
+        ASSERT_EQ(formatted(price), printed(price.toDouble())) << units;
+    }
+}
+
+TEST(TextFormatTest, FormatsDoublesLikePrintf) {
+    char text[kMaxPriceChars];
+    for (double value : {0.0, 5.51, 0.125, 2.675, -0.001, 1e9}) {
+        ASSERT_EQ(std::string(text, formatDecimal2(text, value) - text), printed(value));
+    }
+}
+
+TEST(TextFormatTest, WritesShortestExactPrices) {
+    char text[kMaxPriceChars];
+    const std::pair<int64_t, const char*> cases[] = {
+        {13400000000LL, "13.4"}, {13000000000LL, "13.0"}, {13575000000LL, "13.575"}, {0LL, "0.0"},
+        {1LL, "0.000000001"}, {5010000000LL, "5.01"}, {-500000000LL, "-0.5"}, {123456789012LL, "123.456789012"},
+    };
+    for (const auto& [units, expected] : cases) {
+        ASSERT_EQ(std::string(text, formatPriceShort(text, FixedPrice{units}) - text), expected) << units;
+    }
+}
@@ -0,0 +1,124 @@
+// Converts an MBO CSV export (like data/mbo.csv) into a DBN v2 MBO file, so
+// the binary input path can be exercised and benchmarked against the same data.
+//
+// Usage: ./csv_to_dbn <input.csv> <output.dbn>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../src/csv_scanner.h"
+#include "../src/dbn.h"
+#include "../src/field_parsers.h"
+#include "../src/input_source.h"
+#include "../src/mbo_decoder.h"
+
+namespace {
+
+// YYYYMMDD of the UTC day containing `ns`, offset by `day_offset` days.
+uint32_t yyyymmdd(int64_t ns, int day_offset = 0) {
+    int64_t days = ns / (86400 * kNanosPerSecond) + day_offset;
+    int64_t year;
+    unsigned month, day;
+    parse_detail::civilFromDays(days, year, month, day);
+    return static_cast<uint32_t>(year * 10000 + month * 100 + day);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: ./csv_to_dbn <input.csv> <output.dbn>\n";
+        return 1;
+    }
+
+    InputFile input;
+    if (!input.open(argv[1], true)) {
+        std::cerr << "Error: Could not open input file " << argv[1] << "\n";
+        return 1;
+    }
+    std::string_view lines = input.view();
+    size_t first_newline = lines.find('\n');
+    MboColumnPlan plan;
+    std::string_view missing_column;
+    if (!MboColumnPlan::fromHeader(lines.substr(0, first_newline), plan, missing_column)) {
+        std::cerr << "Error: Input header has no '" << missing_column << "' column.\n";
+        return 1;
+    }
+    lines = (first_newline == std::string_view::npos) ? std::string_view() : lines.substr(first_newline + 1);
+
+    std::vector<DbnMboRecord> records;
+    std::vector<std::pair<std::string, uint32_t>> symbols;
+    const MboCsvDecoder decoder(plan);
+    StructuralScanner scanner;
+    CsvRecord row;
+    size_t line_number = 1;
+
+    while (!lines.empty()) {
+        size_t block_end = lineBlockLength(lines, 1 << 20);
+        scanner.scan(lines.substr(0, block_end));
+        lines.remove_prefix(block_end);
+
+        while (scanner.next(row)) {
+            ++line_number;
+            if (row.fieldCount() < plan.min_fields) continue;
+
+            MboEvent event;
+            if (!decoder.decode(row, event)) {
+                std::cerr << "Error: Bad ts_event on line " << line_number << "\n";
+                return 1;
+            }
+
+            DbnMboRecord record{};
+            record.hd.length = sizeof(DbnMboRecord) / 4;
+            record.hd.rtype = kDbnRTypeMbo;
+            record.hd.publisher_id = event.publisher_id;
+            record.hd.instrument_id = event.instrument_id;
+            record.hd.ts_event = static_cast<uint64_t>(event.ts_event);
+            // The decoder leaves ts_recv and channel_id alone: the book never needs them.
+            int64_t ts_recv = 0;
+            std::string_view recv_text = plan.optional(row, MboField::TsRecv);
+            if (recv_text.empty() || !parseTimestamp(recv_text, ts_recv)) ts_recv = event.ts_event;
+            record.ts_recv = static_cast<uint64_t>(ts_recv);
+            record.channel_id = static_cast<uint8_t>(parseInteger(plan.optional(row, MboField::ChannelId)));
+
+            // An empty price (resets, trades without one) is DBN's undefined price.
+            record.price = row.field(plan[MboField::Price]).empty() ? kDbnUndefPrice : event.price.units;
+            record.order_id = static_cast<uint64_t>(event.order_id);
+            record.size = static_cast<uint32_t>(event.size);
+            record.action = event.action;
+            record.side = event.side;
+            record.flags = event.flags;
+            record.ts_in_delta = event.ts_in_delta;
+            record.sequence = event.sequence;
+            records.push_back(record);
+
+            if (!event.symbol.empty()) {
+                std::pair<std::string, uint32_t> entry(std::string(event.symbol), record.hd.instrument_id);
+                if (std::find(symbols.begin(), symbols.end(), entry) == symbols.end()) symbols.push_back(entry);
+            }
+        }
+    }
+
+    uint64_t start_ns = records.empty() ? 0 : records.front().hd.ts_event;
+    uint64_t end_ns = records.empty() ? 0 : records.back().hd.ts_event + 1;
+    std::string metadata = encodeDbnMetadata(start_ns, end_ns, yyyymmdd(start_ns), yyyymmdd(end_ns, 1), symbols);
+
+    std::ofstream out(argv[2], std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "Error: Could not open output file " << argv[2] << "\n";
+        return 1;
+    }
+    out.write(metadata.data(), metadata.size());
+    out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(DbnMboRecord));
+    if (!out) {
+        std::cerr << "Error: Could not write output file " << argv[2] << "\n";
+        return 1;
+    }
+    std::cerr << "Wrote " << records.size() << " MBO records to " << argv[2] << "\n";
+    return 0;
+}
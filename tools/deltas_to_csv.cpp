@@ -0,0 +1,120 @@
+// Rebuilds full snapshots from a delta file (output/mbp_deltas.csv, written
+// with --deltas) as the CSV the reconstructor writes without --deltas.
+// Order counts are included if the delta file has them.
+//
+// Usage: ./deltas_to_csv [--depth-column] [--symbol-column] <input_deltas.csv> <output.csv>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../src/csv_scanner.h"
+#include "../src/input_source.h"
+#include "../src/output_writer.h"
+#include "../src/snapshot_format.h"
+
+int main(int argc, char* argv[]) {
+    SnapshotFormat format;
+    const char* paths[2] = {nullptr, nullptr};
+    int path_count = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg(argv[i]);
+        if (arg == "--depth-column") {
+            format.with_depth = true;
+        } else if (arg == "--symbol-column") {
+            format.with_symbol = true;
+        } else if (path_count < 2 && !arg.empty() && arg[0] != '-') {
+            paths[path_count++] = argv[i];
+        } else {
+            path_count = -1;
+            break;
+        }
+    }
+    if (path_count != 2) {
+        std::cerr << "Usage: ./deltas_to_csv [--depth-column] [--symbol-column] <input_deltas.csv> <output.csv>\n";
+        return 1;
+    }
+
+    InputFile input;
+    if (!input.open(paths[0], true)) {
+        std::cerr << "Error: Could not open input file " << paths[0] << "\n";
+        return 1;
+    }
+    std::string_view lines = input.view();
+    const size_t first_newline = lines.find('\n');
+    DeltaCsvReader reader;
+    if (!reader.readHeader(lines.substr(0, first_newline))) {
+        std::cerr << "Error: " << paths[0] << ": " << reader.error() << "\n";
+        return 1;
+    }
+    lines = (first_newline == std::string_view::npos) ? std::string_view() : lines.substr(first_newline + 1);
+    format.with_counts = reader.withCounts();
+
+    // As in the reconstructor, rows go to a temporary file that replaces the
+    // output only once the whole delta file has been read.
+    const std::string temp_path = std::string(paths[1]) + ".tmp";
+    const int out_fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out_fd < 0) {
+        std::cerr << "Error: Could not open output file " << temp_path << "\n";
+        return 1;
+    }
+    BackgroundWriter writer(out_fd, 1 << 22);
+    // The depth comes from the header line, so a file with no data lines
+    // still converts to a header-only CSV.
+    const std::string header = snapshotCsvHeader(reader.depth(), format);
+    std::memcpy(writer.reserve(header.size()), header.data(), header.size());
+    writer.commit(header.size());
+    bool ok = true;
+    size_t line_number = 1;
+    StructuralScanner scanner;
+    CsvRecord line;
+    while (ok && !lines.empty()) {
+        const size_t block_end = lineBlockLength(lines, 1 << 20);
+        scanner.scan(lines.substr(0, block_end));
+        lines.remove_prefix(block_end);
+        while (ok && scanner.next(line)) {
+            ++line_number;
+            if (!reader.apply(line)) {
+                std::cerr << "Error: " << paths[0] << " line " << line_number << ": " << reader.error() << "\n";
+                ok = false;
+                break;
+            }
+
+            const DeltaCsvReader::Book& book = reader.book();
+            char* const row = writer.reserve(maxSnapshotCsvBytes(reader.depth()) + book.symbol.size() + 1);
+            char* out = row + formatTimestamp(book.ts_event, row);
+            if (format.with_depth) {
+                *out++ = ',';
+                if (reader.changedDepth() >= 0) out = formatInteger(out, reader.changedDepth());
+            }
+            for (const SnapshotLevel& level : book.bids) out = writeLevelCsv(out, level, format.with_counts);
+            for (const SnapshotLevel& level : book.asks) out = writeLevelCsv(out, level, format.with_counts);
+            if (format.with_symbol) {
+                *out++ = ',';
+                std::memcpy(out, book.symbol.data(), book.symbol.size());
+                out += book.symbol.size();
+            }
+            *out++ = '\n';
+            writer.commit(out - row);
+        }
+    }
+
+    const bool written = writer.finish();
+    ::close(out_fd);
+    if (ok && !written) std::cerr << "Error: Could not write " << temp_path << ": " << writer.error() << "\n";
+    if (!ok || !written) {
+        ::unlink(temp_path.c_str());
+        return 1;
+    }
+    if (::rename(temp_path.c_str(), paths[1]) != 0) {
+        std::cerr << "Error: Could not replace " << paths[1] << ": " << std::strerror(errno) << "\n";
+        ::unlink(temp_path.c_str());
+        return 1;
+    }
+    return 0;
+}
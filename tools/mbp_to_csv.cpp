@@ -0,0 +1,91 @@
+// Converts binary snapshots (output/mbp_output.bin, written with --binary)
+// back into the CSV the reconstructor writes, e.g. to diff a binary run
+// against a CSV run or to feed tools that only read text.
+//
+// Usage: ./mbp_to_csv [--counts] [--depth-column] <input.bin> <output.csv>
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../src/input_source.h"
+#include "../src/output_writer.h"
+#include "../src/snapshot_format.h"
+
+int main(int argc, char* argv[]) {
+    SnapshotFormat format;
+    const char* paths[2] = {nullptr, nullptr};
+    int path_count = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg(argv[i]);
+        if (arg == "--counts") {
+            format.with_counts = true;
+        } else if (arg == "--depth-column") {
+            format.with_depth = true;
+        } else if (path_count < 2 && !arg.empty() && arg[0] != '-') {
+            paths[path_count++] = argv[i];
+        } else {
+            path_count = -1;
+            break;
+        }
+    }
+    if (path_count != 2) {
+        std::cerr << "Usage: ./mbp_to_csv [--counts] [--depth-column] <input.bin> <output.csv>\n";
+        return 1;
+    }
+
+    InputFile input;
+    if (!input.open(paths[0], true)) {
+        std::cerr << "Error: Could not open input file " << paths[0] << "\n";
+        return 1;
+    }
+    std::string_view data = input.view();
+    SnapshotFileHeader header;
+    if (data.size() < sizeof(header)) {
+        std::cerr << "Error: " << paths[0] << " is not a binary snapshot file\n";
+        return 1;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0 || header.version != kSnapshotVersion) {
+        std::cerr << "Error: " << paths[0] << " is not a version " << kSnapshotVersion << " binary snapshot file\n";
+        return 1;
+    }
+    if (header.header_bytes < sizeof(header) || header.header_bytes > data.size() ||
+        header.record_bytes != snapshotRecordBytes(header.depth) || header.price_scale != kPriceScale ||
+        header.no_price != kSnapshotNoPrice) {
+        std::cerr << "Error: Unsupported snapshot layout in " << paths[0] << "\n";
+        return 1;
+    }
+    data.remove_prefix(header.header_bytes);
+    if (data.size() % header.record_bytes != 0) {
+        std::cerr << "Error: " << paths[0] << " ends in a partial record\n";
+        return 1;
+    }
+
+    const int out_fd = ::open(paths[1], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out_fd < 0) {
+        std::cerr << "Error: Could not open output file " << paths[1] << "\n";
+        return 1;
+    }
+    BackgroundWriter writer(out_fd, 1 << 22);
+    const std::string csv_header = snapshotCsvHeader(header.depth, format);
+    std::memcpy(writer.reserve(csv_header.size()), csv_header.data(), csv_header.size());
+    writer.commit(csv_header.size());
+
+    const size_t max_row = maxSnapshotCsvBytes(header.depth);
+    for (size_t offset = 0; offset < data.size(); offset += header.record_bytes) {
+        char* row = writer.reserve(max_row);
+        writer.commit(writeSnapshotCsv(row, data.data() + offset, header.depth, format) - row);
+    }
+
+    const bool written = writer.finish();
+    ::close(out_fd);
+    if (!written) {
+        std::cerr << "Error: Could not write " << paths[1] << ": " << writer.error() << "\n";
+        return 1;
+    }
+    return 0;
+}